@@ -3,11 +3,13 @@
 // Containers
 #include <array>
 #include <vector>
+#include <deque>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <optional>
+#include <span>
 
 // Utilities
 #include <memory>
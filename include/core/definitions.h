@@ -25,5 +25,7 @@ using index_t = std::size_t;
     if (value.is_bound_method()) return ValueType::BoundMethod;
     if (value.is_proto()) return ValueType::Proto;
     if (value.is_native_fn()) return ValueType::NativeFn;
+    if (value.is_typed_array()) return ValueType::TypedArray;
+    if (value.is_rope()) return ValueType::Rope;
     return ValueType::Null;
 }
\ No newline at end of file
@@ -1,17 +1,66 @@
 #pragma once
 
 #include "core/value.h"
+#include "core/value_table.h"
+#include "core/utf8.h"
 #include "core/op_codes.h"
 #include "core/meow_object.h"
 #include "core/definitions.h"
 #include "common/pch.h"
 
+class MemoryManager;
+
 struct Instruction {
     OpCode op;
     std::vector<Int> args;
+    Int cache = -1;
+    Int firstDead = -1;  // CALL only: first caller register never read after the call returns, -1 when unknown
     Instruction(OpCode op = OpCode::HALT, std::vector<Int> args = {}) : op(op), args(std::move(args)) {}
 };
 
+/// @brief Per-instruction property cache: receiver shape -> field slot, shape transition or class method
+struct PropertyCache {
+    static constexpr size_t MAX_ENTRIES = 4;
+    enum class State : Uint8 { UNINITIALIZED, MONOMORPHIC, POLYMORPHIC, MEGAMORPHIC };
+
+    struct Entry {
+        Shape shape = nullptr;
+        Int slot = -1;
+        Shape transition = nullptr;
+        Value method;
+        Uint64 epoch = 0;
+    };
+
+    State state = State::UNINITIALIZED;
+    size_t count = 0;
+    std::array<Entry, MAX_ENTRIES> entries;
+
+    [[nodiscard]] inline Entry* find(Shape shape) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            if (entries[i].shape == shape) return &entries[i];
+        }
+        return nullptr;
+    }
+
+    inline void add(Entry entry) {
+        if (state == State::MEGAMORPHIC) return;
+        for (size_t i = 0; i < count; ++i) {
+            if (entries[i].shape == entry.shape) {
+                entries[i] = std::move(entry);
+                return;
+            }
+        }
+        if (count == MAX_ENTRIES) {
+            state = State::MEGAMORPHIC;
+            count = 0;
+            entries = {};
+            return;
+        }
+        entries[count++] = std::move(entry);
+        state = (count == 1) ? State::MONOMORPHIC : State::POLYMORPHIC;
+    }
+};
+
 struct UpvalueDesc {
     Bool isLocal;
     Int index;
@@ -25,6 +74,12 @@ struct ExceptionHandler {
     ExceptionHandler(Int c = 0, Int f = 0, Int s = 0) : catchIp(c), frameDepth(f), stackDepth(s) {}
 };
 
+/// @brief Where the bodies of functions skipped at load time come from (see ObjFunctionProto::lazyBody)
+struct LazyBodySource : public MeowObject {
+    /// @brief Fills in the code, constants and upvalue descriptors of `proto`. Never allocates GC objects
+    virtual Bool load(ObjFunctionProto& proto, Str& error) = 0;
+};
+
 struct ObjFunctionProto : public MeowObject {
     Int numRegisters = 0;
     Int numUpvalues = 0;
@@ -32,28 +87,54 @@ struct ObjFunctionProto : public MeowObject {
     std::vector<Instruction> code;
     std::vector<Value> constantPool;
     std::vector<UpvalueDesc> upvalueDescs;
+    std::vector<PropertyCache> propertyCaches;
+    Module linkedModule = nullptr;  // module whose global slots the GET_GLOBAL/SET_GLOBAL caches index
     std::unordered_map<Str, Int> labels;
     std::vector<std::tuple<Int, Int, Str>> pendingJumps;
+    LazyBodySource* lazyBody = nullptr;  // set until the body is loaded; keeps the protos it may refer to alive
+    Uint32 lazyIndex = 0;                // which of `lazyBody`'s functions this is
 
     ObjFunctionProto(Int regs = 0, Int ups = 0, Str name = "<anon>")
         : numRegisters(regs), numUpvalues(ups), sourceName(std::move(name)) {}
 
-    inline void trace(GCVisitor& visitor) const noexcept override {
-        for (auto& constant : constantPool) {
-            visitor.visit_value(constant);
+    /// @brief Gives every property access instruction its own inline cache and plans every CALL's
+    /// register window. Call once the code is final and the protos it creates closures of are loaded
+    inline void attachInlineCaches() {
+        propertyCaches.clear();
+        for (auto& inst : code) {
+            if (inst.op == OpCode::GET_PROP || inst.op == OpCode::SET_PROP) {
+                inst.cache = static_cast<Int>(propertyCaches.size());
+                propertyCaches.emplace_back();
+            }
         }
+        planCallWindows();
     }
+
+    /// @brief Sets each CALL's firstDead to the first register of the caller that is never read again
+    /// after the call returns (-1 when unknown), so the callee's registers can start on its arguments
+    void planCallWindows();
+
+    [[nodiscard]] inline Bool isLoaded() const noexcept { return lazyBody == nullptr; }
+    /// @brief Loads a lazy body, then attaches its caches and links it into `linkedModule`
+    Bool loadBody(Str& error);
+
+    // Cached shapes are only forward-declared here, so tracing lives in objects.cpp
+    void trace(GCVisitor& visitor) const noexcept override;
 };
 
 struct ObjModule : public MeowObject {
     Str name;
     Str path;
-    std::unordered_map<Str, Value> globals;
+    std::vector<Value> globalSlots;             // indexed by linked GET_GLOBAL/SET_GLOBAL instructions
+    std::unordered_map<Str, Int> globalIndex;   // name -> slot, for linking and dynamic access
+    Module builtins = nullptr;                  // shared, read-only scope that global lookups fall back to
     std::unordered_map<Str, Value> exports;
+    // Link-time export number -> entry of `exports` (entries never move), null until the module exports it
+    std::vector<std::unordered_map<Str, Value>::value_type*> exportSlots;
     Bool isExecuted = false;
     Bool isBinary = false;
 
-    Proto mainProto;
+    Proto mainProto = nullptr;
     Bool hasMain = false;
 
     Bool isExecuting = false;
@@ -61,10 +142,66 @@ struct ObjModule : public MeowObject {
     ObjModule(Str n = "", Str p = "", Bool b = false)
         : name(std::move(n)), path(std::move(p)), isBinary(b) {}
 
+    // --- Globals ---
+
+    /// @brief Slot of global `name`, reserving one if absent. A new slot starts out holding the builtin
+    /// of the same name (or null), so only the builtins a module actually uses end up in its slots
+    inline Int globalSlot(const Str& name) {
+        auto [it, inserted] = globalIndex.try_emplace(name, static_cast<Int>(globalSlots.size()));
+        if (inserted) {
+            const Value* builtin = builtins ? builtins->findGlobal(name) : nullptr;
+            globalSlots.push_back(builtin ? *builtin : Value(Null{}));
+        }
+        return it->second;
+    }
+    /// @brief Value of global `name`, falling back to the builtins (valid until the next slot is reserved), or nullptr
+    [[nodiscard]] inline const Value* findGlobal(const Str& name) const noexcept {
+        auto it = globalIndex.find(name);
+        if (it != globalIndex.end()) return &globalSlots[it->second];
+        return builtins ? builtins->findGlobal(name) : nullptr;
+    }
+    inline void setGlobal(const Str& name, const Value& value) { globalSlots[globalSlot(name)] = value; }
+    /// @brief Calls `fn(name, value)` for every global of this module (builtins not included), including
+    /// slots reserved by linking and still null
+    template <typename Fn>
+    inline void forEachGlobal(Fn&& fn) const {
+        for (const auto& [name, slot] : globalIndex) fn(name, globalSlots[slot]);
+    }
+
+    // --- Exports ---
+
+    /// @brief Sets export `name`. `slot` is the number meow-link gave the name, or -1 outside a linked program
+    inline void setExport(const Str& name, const Value& value, Int slot = -1) {
+        auto entry = exports.insert_or_assign(name, value).first;
+        if (slot < 0) return;
+        if (slot >= static_cast<Int>(exportSlots.size())) exportSlots.resize(static_cast<size_t>(slot) + 1, nullptr);
+        exportSlots[slot] = &*entry;
+    }
+    /// @brief Export numbered `slot` by meow-link, or nullptr if this module has not exported it under that number
+    [[nodiscard]] inline const Value* findExport(Int slot) const noexcept {
+        if (slot < 0 || slot >= static_cast<Int>(exportSlots.size()) || !exportSlots[slot]) return nullptr;
+        return &exportSlots[slot]->second;
+    }
+
+    /// @brief Resolves the global names used by `proto` to slots of this module, caching them in the
+    /// instructions. The slots are only used while the code runs with this module as its frame's module
+    inline void link(Proto proto) {
+        proto->linkedModule = this;
+        for (auto& inst : proto->code) {
+            Int nameArg = inst.op == OpCode::GET_GLOBAL ? 1 : inst.op == OpCode::SET_GLOBAL ? 0 : -1;
+            if (nameArg < 0 || nameArg >= static_cast<Int>(inst.args.size())) continue;
+            Int constIdx = inst.args[nameArg];
+            if (constIdx < 0 || constIdx >= static_cast<Int>(proto->constantPool.size())) continue;
+            if (!proto->constantPool[constIdx].is_string()) continue;
+            inst.cache = globalSlot(proto->constantPool[constIdx].get<Str>());
+        }
+    }
+
     inline void trace(GCVisitor& visitor) const noexcept override {
-        for (auto& kv : globals) visitor.visit_value(kv.second);
+        for (auto& value : globalSlots) visitor.visit_value(value);
         for (auto& kv : exports) visitor.visit_value(kv.second);
         visitor.visit_object(mainProto);
+        visitor.visit_object(builtins);
     }
 };
 
@@ -107,12 +244,75 @@ struct CallFrame {
         : closure(c), slotStart(start), module(m), ip(ip_), retReg(ret) {}
 };
 
+// A shape only records the one property it adds on top of its parent. Every TABLE_STRIDE-th shape also
+// indexes the names added since the previous such shape, so a lookup scans at most TABLE_STRIDE - 1 names
+// before it can skip a whole segment of the chain, and a chain of n shapes stays O(n) in memory
+struct ObjShape : public MeowObject {
+    static constexpr Int TABLE_STRIDE = 8;
+
+    Shape parent = nullptr;
+    Str name;
+    Int slotCount = 0;
+    std::unordered_map<Str, Shape> transitions;
+    std::unordered_map<Str, Int> segment;  // only on shapes whose slotCount is a multiple of TABLE_STRIDE
+    Shape segmentBase = nullptr;           // the ancestor the segment starts after
+
+    ObjShape() = default;
+    ObjShape(Shape p, Str n) : parent(p), name(std::move(n)), slotCount(p->slotCount + 1) {
+        buildSegment();
+    }
+
+    /// @brief Indexes the last TABLE_STRIDE names of the chain if this shape ends a segment.
+    /// Needs `parent`, `name` and `slotCount` of every ancestor in the segment
+    inline void buildSegment() {
+        segment.clear();
+        segmentBase = nullptr;
+        if (slotCount == 0 || slotCount % TABLE_STRIDE != 0) return;
+        Shape cur = this;
+        for (Int i = 0; i < TABLE_STRIDE; ++i, cur = cur->parent) segment.emplace(cur->name, cur->slotCount - 1);
+        segmentBase = cur;
+    }
+
+    /// @brief Slot index of a property in this layout, or -1 if the layout does not have it
+    [[nodiscard]] inline Int lookup(const Str& key) const noexcept {
+        const ObjShape* cur = this;
+        while (cur && cur->slotCount > 0) {
+            if (cur->segmentBase) {
+                if (auto it = cur->segment.find(key); it != cur->segment.end()) return it->second;
+                cur = cur->segmentBase;
+            } else {
+                if (cur->name == key) return cur->slotCount - 1;
+                cur = cur->parent;
+            }
+        }
+        return -1;
+    }
+
+    inline void trace(GCVisitor& visitor) const noexcept override {
+        visitor.visit_object(parent);
+        for (auto& transition : transitions) {
+            visitor.visit_object(transition.second);
+        }
+    }
+};
+
 struct ObjClass : public MeowObject {
     Str name;
     std::optional<Class> superclass;
     std::unordered_map<Str, Value> methods;
+    Shape instanceShape = nullptr;
+
+    // Flattened view of `methods` over the whole superclass chain, valid while `resolvedEpoch` matches
+    std::unordered_map<Str, Value> resolvedMethods;
+    Uint64 resolvedEpoch = ~Uint64{0};
+
     ObjClass(Str n = "") : name(std::move(n)) {}
 
+    /// @brief Resolves a method through the superclass chain with a single probe.
+    /// @param epoch Class hierarchy epoch; the flattened table is rebuilt when it has moved on
+    /// @return Pointer into the table (valid until the next rebuild), or nullptr
+    const Value* findMethod(const Str& name, Uint64 epoch);
+
     inline void trace(GCVisitor& visitor) const noexcept override {
         if (superclass) {
             visitor.visit_object(*superclass);
@@ -120,18 +320,103 @@ struct ObjClass : public MeowObject {
         for (auto& method : methods) {
             visitor.visit_value(method.second);
         }
+        for (auto& method : resolvedMethods) {
+            visitor.visit_value(method.second);
+        }
+        visitor.visit_object(instanceShape);
     }
 };
 
 struct ObjInstance : public MeowObject {
+    static constexpr Int INLINE_SLOTS = 4;
+    static constexpr Int MAX_SHAPE_SLOTS = 64;
+
     Class klass;
-    std::unordered_map<Str, Value> fields;
-    ObjInstance(Class k = nullptr) : klass(k) {}
+    Shape shape = nullptr;
+    std::array<Value, INLINE_SLOTS> inlineSlots;
+    std::vector<Value> extraSlots;
+    std::unique_ptr<ValueTable> dictionary;  // string keys only
+    ObjInstance(Class k = nullptr) : klass(k), shape(k ? k->instanceShape : nullptr) {}
+
+    [[nodiscard]] inline bool isDictionary() const noexcept { return dictionary != nullptr; }
+    [[nodiscard]] inline Value& slotAt(Int slot) noexcept {
+        return slot < INLINE_SLOTS ? inlineSlots[slot] : extraSlots[slot - INLINE_SLOTS];
+    }
+    [[nodiscard]] inline const Value& slotAt(Int slot) const noexcept {
+        return slot < INLINE_SLOTS ? inlineSlots[slot] : extraSlots[slot - INLINE_SLOTS];
+    }
+    [[nodiscard]] inline size_t fieldCount() const noexcept {
+        if (dictionary) return dictionary->size();
+        return shape ? static_cast<size_t>(shape->slotCount) : 0;
+    }
+
+    /// @brief Pointer to the field's storage, or nullptr if the instance has no such field
+    [[nodiscard]] inline Value* getField(const Str& key) noexcept {
+        if (dictionary) return dictionary->findString(key);
+        if (!shape) return nullptr;
+        Int slot = shape->lookup(key);
+        return slot >= 0 ? &slotAt(slot) : nullptr;
+    }
+
+    /// @brief Moves to a shape that extends the current one by a single property and stores its value
+    inline void appendSlot(Shape next, const Value& value) {
+        Int slot = next->slotCount - 1;
+        if (slot >= INLINE_SLOTS) extraSlots.push_back(value);
+        else inlineSlots[slot] = value;
+        shape = next;
+    }
+
+    /// @brief Adds or updates a field. Adding may allocate a shape transition on the heap
+    void setField(const Str& key, const Value& value, MemoryManager& heap);
+    /// @brief Removes a field, switching the instance to dictionary mode
+    bool removeField(const Str& key);
+    /// @brief Drops the shape and moves every field into the fallback hash table
+    void toDictionary();
+
+    /// @brief Resumable iteration in insertion order: the field at position `cursor`, advancing it.
+    /// Returns false once past the last field. Positions survive a switch to dictionary mode
+    inline bool nextField(size_t& cursor, const Str*& name, const Value*& value) const noexcept {
+        if (dictionary) {
+            const Value* key = nullptr;
+            if (!dictionary->nextEntry(cursor, key, value)) return false;
+            name = &key->get<Str>();
+            return true;
+        }
+        if (!shape || static_cast<Int>(cursor) >= shape->slotCount) return false;
+        Shape owner = shape;
+        while (owner->slotCount > static_cast<Int>(cursor) + 1) owner = owner->parent;
+        name = &owner->name;
+        value = &slotAt(static_cast<Int>(cursor++));
+        return true;
+    }
+
+    /// @brief Visits fields in insertion order
+    template <typename Fn> inline void forEachField(Fn&& fn) const {
+        if (dictionary) {
+            dictionary->forEach([&](const Value& key, const Value& value) { fn(key.get<Str>(), value); });
+            return;
+        }
+        std::vector<Shape> chain;
+        for (Shape cur = shape; cur && cur->parent; cur = cur->parent) chain.push_back(cur);
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            fn((*it)->name, slotAt((*it)->slotCount - 1));
+        }
+    }
 
     inline void trace(GCVisitor& visitor) const noexcept override {
         visitor.visit_object(klass);
-        for (auto& field : fields) {
-            visitor.visit_value(field.second);
+        visitor.visit_object(shape);
+        Int used = shape ? std::min(shape->slotCount, INLINE_SLOTS) : 0;
+        for (Int i = 0; i < used; ++i) {
+            visitor.visit_value(inlineSlots[i]);
+        }
+        for (auto& slot : extraSlots) {
+            visitor.visit_value(slot);
+        }
+        if (dictionary) {
+            dictionary->forEach([&](const Value&, const Value& value) {
+                visitor.visit_value(value);
+            });
         }
     }
 };
@@ -160,19 +445,38 @@ struct ObjBoundMethod : public MeowObject {
 // };
 
 class ObjArray : public MeowObject {
+public:
+    /// @brief Storage representation. An array stays packed (unboxed) while every element has the
+    /// same primitive type and moves to GENERIC on the first mismatching write, never back
+    enum class ElementsKind : Uint8 { PACKED_INT, PACKED_REAL, GENERIC };
 private:
     using value_t = Value;
-    using reference_t = value_t&;
-    using const_reference_t = const value_t&;
     using container_t = std::vector<value_t>;
 
-    container_t elements_;
+    ElementsKind kind_ = ElementsKind::PACKED_INT;
+    std::vector<Int> ints_;    // storage when kind_ == PACKED_INT
+    std::vector<Real> reals_;  // storage when kind_ == PACKED_REAL
+    container_t elements_;     // storage when kind_ == GENERIC
+
+    /// @brief Makes sure `value` can be stored: an empty packed array may still pick either packed kind,
+    /// anything else that does not match goes GENERIC
+    inline void prepareFor(const Value& value) {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: if (value.is_int()) return; break;
+            case ElementsKind::PACKED_REAL: if (value.is_real()) return; break;
+            case ElementsKind::GENERIC: return;
+        }
+        if (size() == 0 && (value.is_int() || value.is_real())) {
+            kind_ = value.is_int() ? ElementsKind::PACKED_INT : ElementsKind::PACKED_REAL;
+            return;
+        }
+        toGeneric();
+    }
 public:
     // --- Constructors & destructor ---
     ObjArray() = default;
-    explicit ObjArray(const container_t& elements) : elements_(elements) {}
-    explicit ObjArray(container_t&& elements) noexcept : elements_(std::move(elements)) {}
-    explicit ObjArray(std::initializer_list<value_t> elements) : elements_(elements) {}
+    explicit ObjArray(const container_t& elements) { append(elements.data(), elements.size()); }
+    explicit ObjArray(std::initializer_list<value_t> elements) { append(elements.begin(), elements.size()); }
 
     // --- Rule of 5 ---
     ObjArray(const ObjArray&) = delete;
@@ -181,68 +485,206 @@ public:
     ObjArray& operator=(ObjArray&&) = delete;
     ~ObjArray() override = default;
 
-    // --- Iterator types ---
-    using iterator = container_t::iterator;
-    using const_iterator = container_t::const_iterator;
-    using reverse_iterator = container_t::reverse_iterator;
-    using const_reverse_iterator = container_t::const_reverse_iterator;
+    // --- Representation ---
+    [[nodiscard]] inline ElementsKind kind() const noexcept { return kind_; }
+    /// @brief Boxes every element. Called on the first write that does not fit the packed kind
+    inline void toGeneric() {
+        if (kind_ == ElementsKind::GENERIC) return;
+        elements_.reserve(size());
+        if (kind_ == ElementsKind::PACKED_INT) {
+            for (Int i : ints_) elements_.emplace_back(i);
+            std::vector<Int>().swap(ints_);
+        } else {
+            for (Real r : reals_) elements_.emplace_back(r);
+            std::vector<Real>().swap(reals_);
+        }
+        kind_ = ElementsKind::GENERIC;
+    }
 
     // --- Element access ---
-    
+
     /// @brief Unchecked element access. For performance-critical code
-    [[nodiscard]] inline const_reference_t get(size_t index) const noexcept {
-        return elements_[index];
+    [[nodiscard]] inline value_t get(size_t index) const noexcept {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: return Value(ints_[index]);
+            case ElementsKind::PACKED_REAL: return Value(reals_[index]);
+            default: return elements_[index];
+        }
     }
-    /// @brief Unchecked element modification. For performance-critical code
-    template <typename T> inline void set(size_t index, T&& value) noexcept {
-        elements_[index] = std::forward<T>(value);
+    /// @brief Unchecked element modification. May change the elements kind
+    inline void set(size_t index, const value_t& value) {
+        prepareFor(value);
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: ints_[index] = value.get<Int>(); break;
+            case ElementsKind::PACKED_REAL: reals_[index] = value.get<Real>(); break;
+            case ElementsKind::GENERIC: elements_[index] = value; break;
+        }
     }
     /// @brief Checked element access. Throws if index is OOB
-    [[nodiscard]] inline const_reference_t at(size_t index) const {
-        return elements_.at(index);
+    [[nodiscard]] inline value_t at(size_t index) const {
+        if (index >= size()) throw std::out_of_range("ObjArray::at");
+        return get(index);
     }
-    inline const_reference_t operator[](size_t index) const noexcept { return elements_[index]; }
-    inline reference_t operator[](size_t index) noexcept { return elements_[index]; }
-    [[nodiscard]] inline const_reference_t front() const noexcept { return elements_.front(); }
-    [[nodiscard]] inline reference_t front() noexcept { return elements_.front(); }
-    [[nodiscard]] inline const_reference_t back() const noexcept { return elements_.back(); }
-    [[nodiscard]] inline reference_t back() noexcept { return elements_.back(); }
+    inline value_t operator[](size_t index) const noexcept { return get(index); }
+    [[nodiscard]] inline value_t front() const noexcept { return get(0); }
+    [[nodiscard]] inline value_t back() const noexcept { return get(size() - 1); }
 
     // --- Capacity ---
-    [[nodiscard]] inline size_t size() const noexcept { return elements_.size(); }
-    [[nodiscard]] inline bool empty() const noexcept { return elements_.empty(); }
-    [[nodiscard]] inline size_t capacity() const noexcept { return elements_.capacity(); }
+    [[nodiscard]] inline size_t size() const noexcept {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: return ints_.size();
+            case ElementsKind::PACKED_REAL: return reals_.size();
+            default: return elements_.size();
+        }
+    }
+    [[nodiscard]] inline bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] inline size_t capacity() const noexcept {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: return ints_.capacity();
+            case ElementsKind::PACKED_REAL: return reals_.capacity();
+            default: return elements_.capacity();
+        }
+    }
 
     // --- Modifiers ---
-    template <typename T> inline void push(T&& value) { 
-        elements_.emplace_back(std::forward<T>(value));
+    inline void push(const value_t& value) {
+        prepareFor(value);
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: ints_.push_back(value.get<Int>()); break;
+            case ElementsKind::PACKED_REAL: reals_.push_back(value.get<Real>()); break;
+            case ElementsKind::GENERIC: elements_.push_back(value); break;
+        }
+    }
+    inline void pop() noexcept {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: ints_.pop_back(); break;
+            case ElementsKind::PACKED_REAL: reals_.pop_back(); break;
+            case ElementsKind::GENERIC: elements_.pop_back(); break;
+        }
     }
-    inline void pop() noexcept { elements_.pop_back(); }
     template <typename... Args> inline void emplace(Args&&... args) {
-        elements_.emplace_back(std::forward<Args>(args)...);
+        push(value_t(std::forward<Args>(args)...));
+    }
+    /// @brief Pushes `count` values. The elements kind they lead to is worked out first, so only the
+    /// storage that ends up holding them is reserved
+    inline void append(const value_t* values, size_t count) {
+        if (count == 0) return;
+        ElementsKind target = kind_;
+        for (size_t i = 0; i < count && target != ElementsKind::GENERIC; ++i) {
+            const Value& value = values[i];
+            if (target == ElementsKind::PACKED_INT && value.is_int()) continue;
+            if (target == ElementsKind::PACKED_REAL && value.is_real()) continue;
+            if (i == 0 && empty() && (value.is_int() || value.is_real())) {
+                target = value.is_int() ? ElementsKind::PACKED_INT : ElementsKind::PACKED_REAL;
+            } else {
+                target = ElementsKind::GENERIC;
+            }
+        }
+        if (target == ElementsKind::GENERIC) toGeneric();
+        else if (empty()) kind_ = target;
+        reserve(size() + count);
+        for (size_t i = 0; i < count; ++i) push(values[i]);
+    }
+    /// @brief Growing fills with null, which only a GENERIC array can hold
+    inline void resize(size_t size) {
+        if (size > this->size()) toGeneric();
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: ints_.resize(size); break;
+            case ElementsKind::PACKED_REAL: reals_.resize(size); break;
+            case ElementsKind::GENERIC: elements_.resize(size); break;
+        }
+    }
+    inline void reserve(size_t capacity) {
+        switch (kind_) {
+            case ElementsKind::PACKED_INT: ints_.reserve(capacity); break;
+            case ElementsKind::PACKED_REAL: reals_.reserve(capacity); break;
+            case ElementsKind::GENERIC: elements_.reserve(capacity); break;
+        }
+    }
+    inline void shrink() {
+        ints_.shrink_to_fit();
+        reals_.shrink_to_fit();
+        elements_.shrink_to_fit();
+    }
+    inline void clear() {
+        ints_.clear();
+        reals_.clear();
+        elements_.clear();
+        kind_ = ElementsKind::PACKED_INT;
     }
-    inline void resize(size_t size) { elements_.resize(size); }
-    inline void reserve(size_t capacity) { elements_.reserve(capacity); }
-    inline void shrink() { elements_.shrink_to_fit(); }
-    inline void clear() { elements_.clear(); }
-
-    // --- Iterators ---
-    inline iterator begin() noexcept { return elements_.begin(); }
-    inline iterator end() noexcept { return elements_.end(); }
-    inline const_iterator begin() const noexcept { return elements_.begin(); }
-    inline const_iterator end() const noexcept { return elements_.end(); }
-    inline reverse_iterator rbegin() noexcept { return elements_.rbegin(); }
-    inline reverse_iterator rend() noexcept { return elements_.rend(); }
-    inline const_reverse_iterator rbegin() const noexcept { return elements_.rbegin(); }
-    inline const_reverse_iterator rend() const noexcept { return elements_.rend(); }
 
+    // Packed elements are plain numbers, so only GENERIC arrays have anything to trace
     inline void trace(GCVisitor& visitor) const noexcept override {
+        if (kind_ != ElementsKind::GENERIC) return;
         for (auto& element : elements_) {
             visitor.visit_value(element);
         }
     }
 };
 
+/// @brief Packed array of 64-bit ints or doubles. Elements are stored unboxed, 8 bytes each
+class ObjTypedArray : public MeowObject {
+public:
+    enum class Kind : Uint8 { INT64, FLOAT64 };
+private:
+    Kind kind_;
+    std::vector<Int> ints_;    // storage when kind_ == Kind::INT64
+    std::vector<Real> reals_;  // storage when kind_ == Kind::FLOAT64
+public:
+    // --- Constructors & destructor ---
+    explicit ObjTypedArray(Kind kind, size_t size = 0) : kind_(kind) { resize(size); }
+
+    // --- Rule of 5 ---
+    ObjTypedArray(const ObjTypedArray&) = delete;
+    ObjTypedArray(ObjTypedArray&&) = delete;
+    ObjTypedArray& operator=(const ObjTypedArray&) = delete;
+    ObjTypedArray& operator=(ObjTypedArray&&) = delete;
+    ~ObjTypedArray() override = default;
+
+    // --- Type ---
+    [[nodiscard]] inline Kind kind() const noexcept { return kind_; }
+    [[nodiscard]] inline bool isFloat() const noexcept { return kind_ == Kind::FLOAT64; }
+    [[nodiscard]] inline const char* typeName() const noexcept { return isFloat() ? "Float64Array" : "Int64Array"; }
+
+    // --- Raw storage, for the bulk kernels ---
+    [[nodiscard]] inline Int* ints() noexcept { return ints_.data(); }
+    [[nodiscard]] inline const Int* ints() const noexcept { return ints_.data(); }
+    [[nodiscard]] inline Real* reals() noexcept { return reals_.data(); }
+    [[nodiscard]] inline const Real* reals() const noexcept { return reals_.data(); }
+
+    // --- Element access ---
+
+    /// @brief Unchecked element access, boxed as Int or Real
+    [[nodiscard]] inline Value get(size_t index) const noexcept {
+        return isFloat() ? Value(reals_[index]) : Value(ints_[index]);
+    }
+    /// @brief Unchecked store converting to the element type. Returns false if `value` is not a number
+    inline bool set(size_t index, const Value& value) noexcept {
+        if (const Int* i = value.get_if<Int>()) {
+            if (isFloat()) reals_[index] = static_cast<Real>(*i);
+            else ints_[index] = *i;
+            return true;
+        }
+        if (const Real* r = value.get_if<Real>()) {
+            if (isFloat()) reals_[index] = *r;
+            else ints_[index] = static_cast<Int>(*r);
+            return true;
+        }
+        return false;
+    }
+
+    // --- Capacity ---
+    [[nodiscard]] inline size_t size() const noexcept { return isFloat() ? reals_.size() : ints_.size(); }
+    [[nodiscard]] inline bool empty() const noexcept { return size() == 0; }
+    inline void resize(size_t size) {
+        if (isFloat()) reals_.resize(size);
+        else ints_.resize(size);
+    }
+
+    // Holds no references
+    inline void trace(GCVisitor&) const noexcept override {}
+};
+
 class ObjString : public MeowObject {
 private:
     using string_t = std::string;
@@ -288,14 +730,160 @@ public:
     inline void trace(GCVisitor&) const noexcept override {}
 };
 
+/**
+ * @brief Heap string with lazy contents: the result of ADD on long strings, or a slice of another rope.
+ *
+ * A concatenation keeps both sides (each a `Str` or another rope), so building a string with
+ * `s = s + x` copies only `x`; the characters are joined the first time something needs them
+ * contiguous and then cached. A slice points into the flat buffer of its parent instead of
+ * copying the range. A flat rope also holds long strings that get indexed, so that their
+ * character index is built once and kept (see MeowVM::_promoteString).
+ */
+class ObjRope : public MeowObject {
+public:
+    enum class Form : Uint8 { CONCAT, FLAT, SLICE };
+private:
+    Form form_;
+    Value left_;   // CONCAT: Str or Rope. SLICE: the flat parent
+    Value right_;  // CONCAT: Str or Rope
+    Str flat_;     // FLAT
+    size_t offset_ = 0;  // SLICE: start in the parent
+    size_t length_;      // in bytes
+    std::unique_ptr<Utf8Index> utf8_;  // built on first character access
+
+    [[nodiscard]] inline std::string_view sliceView() const noexcept {
+        return std::string_view(left_.get<Rope>()->flat_).substr(offset_, length_);
+    }
+
+    /// @brief Calls `fn(std::string_view)` for every piece, left to right. Iterative, since
+    /// repeated appends build chains as long as the loop that made them
+    template <typename Fn>
+    inline void forEachPiece(Fn&& fn) const {
+        std::vector<const Value*> pending;
+        const ObjRope* rope = this;
+        while (true) {
+            switch (rope->form_) {
+                case Form::FLAT: fn(std::string_view(rope->flat_)); break;
+                case Form::SLICE: fn(rope->sliceView()); break;
+                case Form::CONCAT:
+                    pending.push_back(&rope->right_);
+                    pending.push_back(&rope->left_);
+                    break;
+            }
+            for (rope = nullptr; !rope && !pending.empty();) {
+                const Value* piece = pending.back();
+                pending.pop_back();
+                if (piece->is_string()) fn(std::string_view(piece->get<Str>()));
+                else rope = piece->get<Rope>();
+            }
+            if (!rope) return;
+        }
+    }
+public:
+    /// @brief Concatenations and slices shorter than this are built flat; copying them is cheaper than a node
+    static constexpr size_t MIN_LENGTH = 64;
+
+    // --- Constructors & destructor ---
+    /// @brief Concatenation. Both sides must be `Str` or `Rope`
+    ObjRope(const Value& left, const Value& right)
+        : form_(Form::CONCAT), left_(left), right_(right), length_(lengthOf(left) + lengthOf(right)) {}
+    /// @brief Already-flat contents
+    explicit ObjRope(Str flat): form_(Form::FLAT), flat_(std::move(flat)), length_(flat_.size()) {}
+    /// @brief Flat copy of `source` with character `index` (< character count) replaced by `replacement`,
+    /// a single whole character. Takes a copy of the source's character index and patches it, never rescans
+    ObjRope(Rope source, size_t index, std::string_view replacement) : form_(Form::FLAT) {
+        const Utf8Index& chars = source->utf8();
+        std::string_view s = source->view();
+        size_t begin = chars.byteOffset(s, index);
+        size_t width = chars.byteOffset(s, index + 1) - begin;
+        flat_.reserve(s.size() - width + replacement.size());
+        flat_.append(s.substr(0, begin)).append(replacement).append(s.substr(begin + width));
+        length_ = flat_.size();
+        utf8_ = std::make_unique<Utf8Index>(chars);
+        bool asciiForAscii = width == 1 && replacement.size() == 1 &&
+                             static_cast<unsigned char>(s[begin]) < 0x80 && static_cast<unsigned char>(replacement[0]) < 0x80;
+        if (!asciiForAscii) utf8_->replaced(flat_, index, width, replacement);
+    }
+    /// @brief Slice of `source` sharing its buffer. Flattens `source` if needed; slices of slices
+    /// point straight at the original buffer
+    ObjRope(Rope source, size_t offset, size_t length): form_(Form::SLICE), length_(length) {
+        if (source->form_ == Form::SLICE) {
+            offset_ = source->offset_ + offset;
+            left_ = source->left_;
+        } else {
+            (void) source->flatten();
+            offset_ = offset;
+            left_ = Value(source);
+        }
+    }
+
+    // --- Rule of 5 ---
+    ObjRope(const ObjRope&) = delete;
+    ObjRope(ObjRope&&) = delete;
+    ObjRope& operator=(const ObjRope&) = delete;
+    ObjRope& operator=(ObjRope&&) = delete;
+    ~ObjRope() override = default;
+
+    // --- Capacity ---
+    [[nodiscard]] inline Form form() const noexcept { return form_; }
+    [[nodiscard]] inline size_t size() const noexcept { return length_; }
+    [[nodiscard]] inline bool empty() const noexcept { return length_ == 0; }
+
+    // --- String access ---
+
+    /// @brief Contiguous contents as an owned Str. Joins concatenations (and copies slices) on first use
+    [[nodiscard]] inline const Str& flatten() {
+        if (form_ != Form::FLAT) {
+            Str flat;
+            flat.reserve(length_);
+            forEachPiece([&](std::string_view piece) { flat.append(piece); });
+            flat_ = std::move(flat);
+            form_ = Form::FLAT;
+            left_ = Value();
+            right_ = Value();
+            offset_ = 0;
+        }
+        return flat_;
+    }
+    /// @brief Contiguous contents without copying a slice. Valid while this rope is alive
+    [[nodiscard]] inline std::string_view view() {
+        if (form_ == Form::SLICE) return sliceView();
+        return flatten();
+    }
+    /// @brief Character index of the contents. Survives flattening, which keeps the same characters
+    [[nodiscard]] inline const Utf8Index& utf8() {
+        if (!utf8_) utf8_ = std::make_unique<Utf8Index>(view());
+        return *utf8_;
+    }
+    /// @brief Appends the contents to `out` without flattening
+    inline void appendTo(Str& out) const {
+        out.reserve(out.size() + length_);
+        forEachPiece([&](std::string_view piece) { out.append(piece); });
+    }
+    /// @brief Writes the contents to `os` without flattening
+    inline void writeTo(std::ostream& os) const {
+        forEachPiece([&](std::string_view piece) { os.write(piece.data(), static_cast<std::streamsize>(piece.size())); });
+    }
+
+    /// @brief Length of a `Str` or `Rope` value
+    [[nodiscard]] static inline size_t lengthOf(const Value& value) noexcept {
+        return value.is_rope() ? value.get<Rope>()->size() : value.get<Str>().size();
+    }
+
+    inline void trace(GCVisitor& visitor) const noexcept override {
+        visitor.visit_value(left_);
+        visitor.visit_value(right_);
+    }
+};
+
 struct ObjObject : public MeowObject {
-    std::unordered_map<Str, Value> fields;
+    ValueTable fields;
     ObjObject() = default;
-    ObjObject(std::unordered_map<Str, Value> f) : fields(std::move(f)) {}
 
     inline void trace(GCVisitor& visitor) const noexcept override {
-        for (auto& field : fields) {
-            visitor.visit_value(field.second);
-        }
+        fields.forEach([&](const Value& key, const Value& value) {
+            visitor.visit_value(key);
+            visitor.visit_value(value);
+        });
     }
 };
\ No newline at end of file
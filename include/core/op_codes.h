@@ -12,5 +12,6 @@ enum class OpCode {
     BIT_AND, BIT_OR, BIT_XOR, BIT_NOT, LSHIFT, RSHIFT,
     THROW, SETUP_TRY, POP_TRY,
     IMPORT_MODULE, EXPORT, GET_EXPORT, GET_MODULE_EXPORT, IMPORT_ALL,
+    ITER_INIT, ITER_NEXT,
     TOTAL_OPCODES
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+
+/**
+ * @brief UTF-8 scanning and character indexing for strings.
+ *
+ * The scans skip ASCII 16 or 32 bytes at a time (SSE2, or AVX2 when the running CPU has it) and
+ * only look at multi-byte sequences one by one, which suits mostly-ASCII text such as Vietnamese.
+ */
+
+/// @brief Length of the leading run of ASCII bytes
+[[nodiscard]] size_t utf8_ascii_prefix(const char* data, size_t size) noexcept;
+[[nodiscard]] inline bool utf8_is_ascii(const char* data, size_t size) noexcept {
+    return utf8_ascii_prefix(data, size) == size;
+}
+/// @brief Whether the bytes are well-formed UTF-8 (no overlongs, surrogates or code points past U+10FFFF)
+[[nodiscard]] bool utf8_validate(const char* data, size_t size) noexcept;
+
+/// @brief Byte width of the character whose lead byte is `lead`. Only meaningful for valid UTF-8
+[[nodiscard]] inline size_t utf8_lead_width(char lead) noexcept {
+    unsigned char b = static_cast<unsigned char>(lead);
+    return b < 0x80 ? 1 : b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+}
+
+/**
+ * @brief Character positions of one string.
+ *
+ * Pure ASCII strings, and strings that are not valid UTF-8, are indexed by byte. Anything else is
+ * indexed by code point, through the byte offset of every STRIDE-th character, so finding a
+ * character walks at most STRIDE - 1 others. Building the index is a single pass.
+ */
+class Utf8Index {
+private:
+    static constexpr size_t STRIDE = 64;
+
+    bool byteIndexed_ = true;
+    size_t length_ = 0;                // in characters
+    std::vector<size_t> checkpoints_;  // byte offset of characters 0, STRIDE, 2 * STRIDE, ...
+
+    inline size_t offsetOf(std::string_view s, size_t index) const noexcept {
+        size_t pos = checkpoints_[index / STRIDE];
+        for (size_t k = index % STRIDE; k > 0; --k) pos += utf8_lead_width(s[pos]);
+        return pos;
+    }
+public:
+    Utf8Index() = default;
+    explicit Utf8Index(std::string_view s);
+
+    [[nodiscard]] inline size_t length() const noexcept { return length_; }
+    [[nodiscard]] inline bool byteIndexed() const noexcept { return byteIndexed_; }
+
+    /// @brief Byte offset of character `index` in `s` (the string this index was built from); index <= length()
+    [[nodiscard]] inline size_t byteOffset(std::string_view s, size_t index) const noexcept {
+        if (byteIndexed_) return index;
+        return index == length_ ? s.size() : offsetOf(s, index);
+    }
+    /// @brief Bytes of character `index` in `s`; index < length()
+    [[nodiscard]] inline std::string_view charAt(std::string_view s, size_t index) const noexcept {
+        if (byteIndexed_) return s.substr(index, 1);
+        size_t pos = offsetOf(s, index);
+        return s.substr(pos, utf8_lead_width(s[pos]));
+    }
+    /// @brief Updates the index after character `index`, `oldWidth` bytes wide, was replaced in place
+    /// by the single character `replacement`; `s` is the string after the write
+    void replaced(std::string_view s, size_t index, size_t oldWidth, std::string_view replacement);
+    /// @brief Byte width of the character starting at byte `pos` of `s`
+    [[nodiscard]] inline size_t widthAt(std::string_view s, size_t pos) const noexcept {
+        return byteIndexed_ ? 1 : utf8_lead_width(s[pos]);
+    }
+};
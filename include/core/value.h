@@ -13,11 +13,15 @@ struct ObjFunctionProto;
 struct ObjModule;
 struct ObjUpvalue;
 struct ObjBoundMethod;
+struct ObjShape;
+class ObjTypedArray;
+class ObjRope;
 
 class MeowEngine;
 class Value;
 
-using Arguments = const std::vector<Value>&;
+/// @brief Arguments of a native call: a view over the caller's registers, valid for the whole call
+using Arguments = std::span<const Value>;
 
 using Int8 = int8_t;
 using Int16 = int16_t;
@@ -49,10 +53,18 @@ using Function = ObjClosure*;
 using Module = ObjModule*;
 using BoundMethod = ObjBoundMethod*;
 using Proto = ObjFunctionProto*;
+using Shape = ObjShape*;
+using TypedArray = ObjTypedArray*;
+using Rope = ObjRope*;
+
+struct BoundNativeFn;
 
 using NativeFnSimple = std::function<Value(Arguments)>;
 using NativeFnAdvanced = std::function<Value(MeowEngine*, Arguments)>;
-using NativeFn = std::variant<NativeFnSimple, NativeFnAdvanced>;
+/// @brief Builtin methods: the value they were looked up on comes separately from the arguments
+using NativeFnMethod = std::function<Value(MeowEngine*, const Value& receiver, Arguments)>;
+using BoundNative = std::shared_ptr<const BoundNativeFn>;
+using NativeFn = std::variant<NativeFnSimple, NativeFnAdvanced, NativeFnMethod, BoundNative>;
 
 using BaseValue = std::variant<
     Null,
@@ -69,7 +81,9 @@ using BaseValue = std::variant<
     Module,
     BoundMethod,
     Proto,
-    NativeFn
+    NativeFn,
+    TypedArray,
+    Rope
 >;
 
 class Value {
@@ -109,6 +123,8 @@ public:
     [[nodiscard]] inline bool is_function() const noexcept { return is<Function>(); }
     [[nodiscard]] inline bool is_module() const noexcept { return is<Module>(); }
     [[nodiscard]] inline bool is_native_fn() const noexcept { return is<NativeFn>(); }
+    [[nodiscard]] inline bool is_typed_array() const noexcept { return is<TypedArray>(); }
+    [[nodiscard]] inline bool is_rope() const noexcept { return is<Rope>(); }
 
     // [[nodiscard]] inline Null as_null() const noexcept { return get<Null>(); }
     // [[nodiscard]] inline Bool as_bool() const noexcept { return get<Bool>(); }
@@ -140,11 +156,21 @@ public:
     
     template<typename T>
     bool is() const noexcept { return std::holds_alternative<T>(data_); }
+
+    /// @brief Index of the active alternative in `BaseValue`
+    [[nodiscard]] inline size_t index() const noexcept { return data_.index(); }
+};
+
+/// @brief A native looked up on a value (`"abc".slice`); calling it passes `receiver` along.
+/// Not a heap object: the collector reaches `receiver` through whichever Value holds the binding
+struct BoundNativeFn {
+    NativeFn function;  // never itself a BoundNative
+    Value receiver;
 };
 
 enum class ValueType {
     Null, Int, Real, Bool, String,
     Array, HashTable, Upvalue, Function,
     Class, Instance, BoundMethod,
-    Proto, NativeFn, TotalValueTypes
+    Proto, NativeFn, TypedArray, Rope, TotalValueTypes
 };
\ No newline at end of file
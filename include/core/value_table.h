@@ -0,0 +1,211 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Insertion-ordered, Value-keyed hash table (backing store of `ObjObject` and instance dictionaries).
+ *
+ * Compact-dict layout in the style of CPython: entries live densely in insertion order, and a
+ * sparse table of 1-, 2- or 4-byte indices (width picked from the capacity) points into them.
+ * Probing over that sparse table is SwissTable-style: one control byte per slot holds either
+ * EMPTY, DELETED or the low 7 bits of the key's hash, and a whole group of 16 control bytes is
+ * scanned at once (SSE2 when available), so entries are only touched for likely matches. Each
+ * entry also keeps its full hash, which makes growing cheap and rejects most string mismatches
+ * without comparing. Erased entries leave holes that are squeezed out on the next rehash.
+ *
+ * Keys compare by value for Null/Int/Real/Bool/Str and by identity for heap objects.
+ * Integral reals are normalised to ints, so `m[1]` and `m[1.0]` are the same entry.
+ * Native functions have no identity and cannot be keys (see isHashable()).
+ */
+class ValueTable {
+private:
+    using ctrl_t = Int8;
+
+    static constexpr ctrl_t CTRL_EMPTY = -128;
+    static constexpr ctrl_t CTRL_DELETED = -2;
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+    // Hashes are kept to 63 bits; the top bit of a stored hash marks an erased entry
+    static constexpr size_t HASH_MASK = static_cast<size_t>(-1) >> 1;
+    static constexpr size_t ERASED = ~HASH_MASK;
+
+    struct Entry {
+        Value key;
+        Value value;
+        size_t hash = 0;
+    };
+
+    std::vector<Entry> entries_;       // insertion order, erased entries are holes
+    std::unique_ptr<ctrl_t[]> ctrl_;
+    std::unique_ptr<Uint8[]> indices_; // `width_` bytes per slot, each an index into entries_
+    size_t capacity_ = 0;              // 0 or a power of two, multiple of GROUP_WIDTH
+    size_t size_ = 0;
+    Uint8 width_ = 1;
+
+    // --- Group matching ---
+    static inline Uint32 matchByte(const ctrl_t* group, ctrl_t byte) noexcept {
+#if defined(__SSE2__)
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<Uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte))));
+#else
+        Uint32 mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) mask |= static_cast<Uint32>(group[i] == byte) << i;
+        return mask;
+#endif
+    }
+    // EMPTY and DELETED are the only control bytes with the sign bit set
+    static inline Uint32 matchEmptyOrDeleted(const ctrl_t* group) noexcept {
+#if defined(__SSE2__)
+        return static_cast<Uint32>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        Uint32 mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i) mask |= static_cast<Uint32>(group[i] < 0) << i;
+        return mask;
+#endif
+    }
+
+    static inline ctrl_t h2(size_t hash) noexcept { return static_cast<ctrl_t>(hash & 0x7F); }
+    inline size_t groupMask() const noexcept { return capacity_ / GROUP_WIDTH - 1; }
+    // Entries (live or erased) the current capacity can hold before a rehash
+    inline size_t usable() const noexcept { return capacity_ * 7 / 8; }
+
+    // --- Sparse index table ---
+    inline size_t indexAt(size_t slot) const noexcept {
+        switch (width_) {
+            case 1: return indices_[slot];
+            case 2: { Uint16 v; std::memcpy(&v, &indices_[slot * 2], 2); return v; }
+            default: { Uint32 v; std::memcpy(&v, &indices_[slot * 4], 4); return v; }
+        }
+    }
+    inline void setIndexAt(size_t slot, size_t index) noexcept {
+        switch (width_) {
+            case 1: indices_[slot] = static_cast<Uint8>(index); break;
+            case 2: { Uint16 v = static_cast<Uint16>(index); std::memcpy(&indices_[slot * 2], &v, 2); break; }
+            default: { Uint32 v = static_cast<Uint32>(index); std::memcpy(&indices_[slot * 4], &v, 4); break; }
+        }
+    }
+
+    // --- Hashing & equality ---
+    static inline Uint64 mix(Uint64 x) noexcept {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+    static inline size_t hashString(std::string_view s) noexcept {
+        return static_cast<size_t>(mix(std::hash<std::string_view>{}(s))) & HASH_MASK;
+    }
+    static inline bool isIntegral(Real r) noexcept {
+        return std::trunc(r) == r && r >= -9223372036854775808.0 && r < 9223372036854775808.0;
+    }
+    static const void* identityOf(const Value& v) noexcept;
+    static size_t hashOf(const Value& key) noexcept;
+    static bool keyEquals(const Value& a, const Value& b) noexcept;
+
+    // --- Probing ---
+
+    /// @brief Sparse slot holding `key`, or NPOS. `matches(entry)` decides key equality
+    template <typename Matches>
+    inline size_t probe(size_t hash, Matches&& matches) const noexcept {
+        if (capacity_ == 0) return NPOS;
+        size_t mask = groupMask();
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1;; ++step) {
+            const ctrl_t* ctrl = &ctrl_[group * GROUP_WIDTH];
+            for (Uint32 m = matchByte(ctrl, h2(hash)); m; m &= m - 1) {
+                size_t slot = group * GROUP_WIDTH + static_cast<size_t>(__builtin_ctz(m));
+                const Entry& entry = entries_[indexAt(slot)];
+                if (entry.hash == hash && matches(entry)) return slot;
+            }
+            if (matchByte(ctrl, CTRL_EMPTY)) return NPOS;
+            group = (group + step) & mask;
+        }
+    }
+    inline size_t findSlot(const Value& key, size_t hash) const noexcept {
+        return probe(hash, [&](const Entry& entry) { return keyEquals(entry.key, key); });
+    }
+    size_t insertEntry(const Value& key, size_t hash);
+    size_t findFreeSlot(size_t hash) const noexcept;
+    void rehash(size_t newCapacity);
+public:
+    // --- Constructors & destructor ---
+    ValueTable() = default;
+    ValueTable(const ValueTable&) = delete;
+    ValueTable& operator=(const ValueTable&) = delete;
+    ValueTable(ValueTable&&) noexcept = default;
+    ValueTable& operator=(ValueTable&&) noexcept = default;
+    ~ValueTable() = default;
+
+    /// @brief Whether `key` may be used as a key. Callers must check before inserting
+    [[nodiscard]] static inline bool isHashable(const Value& key) noexcept { return !key.is_native_fn(); }
+
+    // --- Lookup ---
+
+    /// @brief Pointer to the value stored under `key` (valid until the next insertion), or nullptr
+    [[nodiscard]] inline Value* find(const Value& key) noexcept {
+        if (const Real* r = key.get_if<Real>(); r && isIntegral(*r)) return find(Value(static_cast<Int>(*r)));
+        size_t slot = findSlot(key, hashOf(key));
+        return slot == NPOS ? nullptr : &entries_[indexAt(slot)].value;
+    }
+    [[nodiscard]] inline const Value* find(const Value& key) const noexcept {
+        return const_cast<ValueTable*>(this)->find(key);
+    }
+    /// @brief String-key lookup that never materialises a `Value`
+    [[nodiscard]] inline Value* findString(std::string_view key) noexcept {
+        size_t slot = probe(hashString(key), [&](const Entry& entry) {
+            return entry.key.is_string() && entry.key.get<Str>() == key;
+        });
+        return slot == NPOS ? nullptr : &entries_[indexAt(slot)].value;
+    }
+    [[nodiscard]] inline bool contains(const Value& key) const noexcept { return find(key) != nullptr; }
+
+    // --- Modifiers ---
+
+    /// @brief Value stored under `key`, appending a null entry first if absent
+    inline Value& operator[](const Value& key) {
+        if (const Real* r = key.get_if<Real>(); r && isIntegral(*r)) return (*this)[Value(static_cast<Int>(*r))];
+        return entries_[insertEntry(key, hashOf(key))].value;
+    }
+    inline void set(const Value& key, const Value& value) { (*this)[key] = value; }
+    /// @brief Removes `key`. Returns whether it was present
+    bool erase(const Value& key);
+    void reserve(size_t count);
+    void clear() noexcept;
+
+    // --- Capacity ---
+    [[nodiscard]] inline size_t size() const noexcept { return size_; }
+    [[nodiscard]] inline bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] inline size_t capacity() const noexcept { return capacity_; }
+
+    // --- Iteration ---
+
+    /// @brief Resumable iteration: the first live entry at or after position `cursor` (insertion order).
+    /// Advances `cursor` past it; returns false once there is none
+    inline bool nextEntry(size_t& cursor, const Value*& key, const Value*& value) const noexcept {
+        while (cursor < entries_.size()) {
+            const Entry& entry = entries_[cursor++];
+            if (!(entry.hash & ERASED)) {
+                key = &entry.key;
+                value = &entry.value;
+                return true;
+            }
+        }
+        return false;
+    }
+    /// @brief Calls `fn(key, value)` for every entry, in insertion order
+    template <typename Fn>
+    inline void forEach(Fn&& fn) const {
+        for (const Entry& entry : entries_) {
+            if (!(entry.hash & ERASED)) fn(entry.key, entry.value);
+        }
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+#include "core/op_codes.h"
+
+#include <bit>
+#include <cstring>
+
+struct ParsedModule;
+struct ParsedFunction;
+
+/**
+ * @brief On-disk layout of compiled `.meowb` modules.
+ *
+ * Everything is addressed by byte offsets from the start of the file, never by pointers, so a file
+ * can be mapped anywhere and read in place. All integers are little-endian and every section
+ * starts on an 8-byte boundary. The file holds a header, the string table, and then, for each
+ * proto, its constants, upvalue descriptors and instruction stream. Protos with identical constant
+ * pools share one copy. Labels are already resolved and `@name` proto references are stored as
+ * proto indices.
+ *
+ * An instruction is a Uint16 opcode, a Uint16 argument count and that many Int32 arguments.
+ */
+
+static_assert(std::endian::native == std::endian::little, ".meowb files are read in place and assume a little-endian host");
+
+inline constexpr char BINARY_MAGIC[8] = { 'M', 'E', 'O', 'W', 'B', 'I', 'N', '\0' };
+/// @brief Bumped on any layout or opcode numbering change; older files are rejected
+inline constexpr Uint32 BINARY_VERSION = 1;
+inline constexpr Uint32 BINARY_NO_INDEX = 0xFFFFFFFFu;
+
+struct BinaryHeader {
+    char magic[8];
+    Uint32 version;
+    Uint32 fileSize;
+    Uint32 stringsOffset;   // BinaryString[stringCount]
+    Uint32 stringCount;
+    Uint32 protosOffset;    // BinaryProto[protoCount]
+    Uint32 protoCount;
+    Uint32 mainProto;       // index of @main, or BINARY_NO_INDEX
+    Uint32 reserved;
+};
+
+struct BinaryString {
+    Uint32 offset;
+    Uint32 length;
+};
+
+struct BinaryProto {
+    Uint32 name;            // string index
+    Uint32 numRegisters;
+    Uint32 numUpvalues;
+    Uint32 constantsOffset; // BinaryConstant[constantCount]
+    Uint32 constantCount;
+    Uint32 upvaluesOffset;  // BinaryUpvalue[upvalueCount]
+    Uint32 upvalueCount;
+    Uint32 codeOffset;      // instruction stream of codeSize bytes
+    Uint32 codeSize;
+    Uint32 instructionCount;
+};
+
+enum class BinaryConstantTag : Uint8 { NUL, INT, REAL, BOOL, STRING, PROTO };
+
+struct BinaryConstant {
+    BinaryConstantTag tag;
+    Uint8 padding[7];
+    Int64 payload;          // the int, the real's bits, the bool, a string index or a proto index
+};
+
+struct BinaryUpvalue {
+    Uint32 isLocal;
+    Uint32 index;
+};
+
+static_assert(sizeof(BinaryHeader) == 40 && sizeof(BinaryString) == 8 && sizeof(BinaryProto) == 40);
+static_assert(sizeof(BinaryConstant) == 16 && sizeof(BinaryUpvalue) == 8);
+
+/*
+ * Linked programs (`.meowl`, written by meow-link) hold a whole program: a LinkedHeader, the module
+ * table, then one `.meowb` image with the protos of every module and a string table they all share.
+ * Each module owns a contiguous run of protos. Its key is its path relative to the `.meowl` file's
+ * directory (absolute if outside it); importers' IMPORT_MODULE constants were rewritten to the key, so
+ * every bundled import is found in the module cache as is. The module's own path is that directory
+ * joined with the key, so the native libraries it imports resolve as they would from source.
+ *
+ * Every export name of the program also gets a number, the same in all modules. meow-link appends it to
+ * EXPORT as a third operand and to GET_EXPORT and GET_MODULE_EXPORT as a fourth, so a bundled export is
+ * read from ObjModule::exportSlots without hashing its name. Constant pools are not merged: as in any
+ * `.meowb`, only byte-identical pools are stored once.
+ */
+
+inline constexpr char LINKED_MAGIC[8] = { 'M', 'E', 'O', 'W', 'L', 'N', 'K', '\0' };
+inline constexpr Uint32 LINKED_VERSION = 2;
+
+struct LinkedHeader {
+    char magic[8];
+    Uint32 version;
+    Uint32 fileSize;
+    Uint32 modulesOffset;   // LinkedModule[moduleCount]
+    Uint32 moduleCount;
+    Uint32 imageOffset;     // the `.meowb` image, imageSize bytes
+    Uint32 imageSize;
+    Uint32 exportCount;     // export numbers used by the code, at most the image's string count
+    Uint32 reserved;
+};
+
+struct LinkedModule {
+    Uint32 path;            // string index in the image
+    Uint32 firstProto;
+    Uint32 protoCount;
+    Uint32 mainProto;       // image proto index
+};
+
+static_assert(sizeof(LinkedHeader) == 40 && sizeof(LinkedModule) == 16);
+
+/// @brief A function to write with writeBinaryImage. Its `::function_proto::<name>` constants are looked up in `scope`
+struct BinaryFunction {
+    const Str* name;
+    const ParsedFunction* function;
+    const std::unordered_map<Str, Uint32>* scope;   // function name -> proto index in the image
+};
+
+/// @brief Bounds- and alignment-checked read access to a `.meowb` image held in memory
+class BinaryModuleView {
+public:
+    /// @brief Validates the header and the string and proto tables. On failure returns false and sets `error`
+    Bool open(std::string_view image, Str& error);
+
+    [[nodiscard]] const BinaryHeader& header() const noexcept { return *header_; }
+    [[nodiscard]] const BinaryProto& proto(Uint32 index) const noexcept { return protos_[index]; }
+    /// @brief String `index` of the string table, viewing the image. False if out of range
+    Bool string(Uint64 index, std::string_view& out) const noexcept;
+    /// @brief Constants and upvalue descriptors of `record`. False if they fall outside the image
+    Bool sections(const BinaryProto& record, const BinaryConstant*& constants, const BinaryUpvalue*& upvalues) const noexcept;
+
+    /// @brief Decodes the instruction stream of `record`, calling `emit(OpCode, std::vector<Int>&&)` for each
+    /// instruction. False if the stream is malformed
+    template <typename Emit>
+    Bool decodeCode(const BinaryProto& record, Emit&& emit) const {
+        if (record.codeSize % sizeof(Uint32) != 0) return false;
+        const Uint32* word = section<Uint32>(record.codeOffset, record.codeSize / sizeof(Uint32));
+        if (!word) return false;
+        // A run of 32-bit words: (op | argc << 16) followed by argc arguments
+        const Uint32* end = word + record.codeSize / sizeof(Uint32);
+        Uint32 count = 0;
+        while (word < end) {
+            Uint16 head[2];
+            std::memcpy(head, word++, sizeof(head));
+            if (head[0] >= static_cast<Uint16>(OpCode::TOTAL_OPCODES) || head[1] > end - word) return false;
+            std::vector<Int> args(head[1]);
+            for (Uint16 a = 0; a < head[1]; ++a) args[a] = static_cast<Int32>(word[a]);
+            word += head[1];
+            emit(static_cast<OpCode>(head[0]), std::move(args));
+            ++count;
+        }
+        return count == record.instructionCount;
+    }
+private:
+    std::string_view bytes_;
+    const BinaryHeader* header_ = nullptr;
+    const BinaryString* strings_ = nullptr;
+    const BinaryProto* protos_ = nullptr;
+
+    template <typename T>
+    const T* section(Uint32 offset, size_t count) const noexcept {
+        if (offset > bytes_.size() || count > (bytes_.size() - offset) / sizeof(T)) return nullptr;
+        const char* p = bytes_.data() + offset;
+        if (reinterpret_cast<uintptr_t>(p) % alignof(T) != 0) return nullptr;
+        return reinterpret_cast<const T*>(p);
+    }
+};
+
+/// @brief Encodes a parsed text module as a `.meowb` image. Returns false and sets `error` if it cannot be represented
+Bool writeBinaryModule(const ParsedModule& module, std::vector<char>& out, Str& error);
+/// @brief Encodes `functions` as a `.meowb` image, in order. `leadingStrings` take the first string indices
+Bool writeBinaryImage(const std::vector<BinaryFunction>& functions, Uint32 mainProto, const std::vector<Str>& leadingStrings,
+                      std::vector<char>& out, Str& error);
+/// @brief Decodes a `.meowb` image back into GC-free form (proto references become `@name` constants again)
+Bool readBinaryModule(std::string_view image, ParsedModule& out, Str& error);
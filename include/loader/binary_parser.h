@@ -0,0 +1,22 @@
+#pragma once
+
+#include "core/objects.h"
+#include "binary_format.h"
+
+class MemoryManager;
+
+/// @brief Loads `.meowb` modules (see binary_format.h) straight from a memory mapping
+class BinaryParser {
+public:
+    std::unordered_map<std::string, Proto> protos;
+    BinaryParser() = default;
+    Bool parseFile(const std::string& filepath, MemoryManager& mm);
+    /// @brief Loads an image already in memory; `sourceName` is only used in error messages
+    Bool parseImage(std::string_view image, const std::string& sourceName, MemoryManager& mm);
+
+    /// @brief Allocates the protos of `image` with empty bodies, into `protos` and in index order into `byIndex`
+    static Bool allocateProtos(const BinaryModuleView& image, MemoryManager& mm, std::unordered_map<std::string, Proto>& protos,
+                               std::vector<Proto>& byIndex, std::string& error);
+    /// @brief Decodes body `index` of `image` into `proto`. PROTO constants refer into `byIndex`
+    static Bool loadBody(const BinaryModuleView& image, Uint32 index, const std::vector<Proto>& byIndex, ObjFunctionProto& proto, std::string& error);
+};
@@ -4,19 +4,71 @@
 
 class MemoryManager;
 
+/// @brief A function as read from source, before it becomes a GC-managed proto
+struct ParsedFunction {
+    Int numRegisters = 0;
+    Int numUpvalues = 0;
+    std::vector<Instruction> code;
+    std::vector<Value> constantPool;
+    std::vector<UpvalueDesc> upvalueDescs;
+    std::unordered_map<Str, Int> labels;
+    std::vector<std::tuple<Int, Int, Str>> pendingJumps;
+};
+
+/// @brief One parsed source file. Holds no GC objects, so it may be produced on any thread
+struct ParsedModule {
+    std::unordered_map<std::string, ParsedFunction> functions;
+    std::vector<std::string> imports;   // IMPORT_MODULE path constants, for prefetching
+    std::string error;                  // set when reading or parsing failed
+};
+
+/// @brief Where one `.func` block sits in its source, as found by BytecodeParser::scan
+struct FunctionExtent {
+    std::string name;
+    Int numRegisters = 0;
+    Int numUpvalues = 0;
+    size_t begin = 0;   // byte range of the block, from `.func` through `.endfunc`
+    size_t end = 0;
+    Int firstLine = 1;
+};
+
+struct ScannedModule {
+    std::vector<FunctionExtent> functions;
+    std::string error;
+};
+
 class BytecodeParser {
 public:
+    /// @brief Bumped whenever the same text may parse to something different, so older cached parses are ignored
+    static constexpr Uint32 VERSION = 2;
+
     std::unordered_map<std::string, Proto> protos;
     BytecodeParser() = default;
     Bool parseFile(const std::string& filepath, MemoryManager& mm);
-    Bool parseSource(const std::string& source, const std::string& sourceName = "<string>");
+    Bool parseSource(const std::string& source, const std::string& sourceName, MemoryManager& mm);
+
+    /// @brief Reads and parses a file without allocating GC objects. Separate parser instances may run concurrently
+    ParsedModule readFile(const std::string& filepath);
+    /// @brief Parses `source` in one pass; tokens are views into it, so it only has to outlive the call
+    ParsedModule read(std::string_view source, const std::string& sourceName = "<string>", Int firstLine = 1);
+    /// @brief Finds the `.func` blocks of `source` and their register/upvalue counts without parsing any body
+    ScannedModule scan(std::string_view source, const std::string& sourceName);
+    /// @brief Allocates the protos of `parsed` into `protos` and links them. VM thread only
+    Bool materialize(ParsedModule&& parsed, MemoryManager& mm);
+    /// @brief Fills `module.imports` from the IMPORT_MODULE instructions of its functions
+    static void collectImports(ParsedModule& module);
+    /// @brief Moves a parsed body into `proto`; its function constants still name their protos
+    static void fillProto(ParsedFunction&& function, ObjFunctionProto& proto);
+    /// @brief Replaces the `::function_proto::<name>` constants of `proto` with the protos they name
+    static void resolveProtoConstants(ObjFunctionProto& proto, const std::unordered_map<std::string, Proto>& protos);
 private:
-    MemoryManager* memoryManager = nullptr;
-    Proto currentProto = nullptr;
-    Bool parseLine(const std::string& line, const std::string& sourceName, Int lineNumber);
-    Bool parseDirective(const std::vector<std::string>& parts, const std::string& sourceName, Int lineNumber);
-    Value parseConstValue(const std::string& token);
-    std::vector<std::string> split(const std::string& s);
+    ParsedModule* module = nullptr;
+    ParsedFunction* currentProto = nullptr;
+    std::vector<std::string_view> tokens;   // tokens of the current line, reused across lines
+    Bool parseLine(std::string_view line);
+    Bool parseDirective(std::string_view line);
+    Value parseConstValue(std::string_view token);
+    void split(std::string_view line);
     void resolveAllLabels();
     void linkProtos();
 };
\ No newline at end of file
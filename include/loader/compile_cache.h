@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common/pch.h"
+#include "bytecode_parser.h"
+
+/**
+ * @brief Persistent on-disk cache of parsed text modules.
+ *
+ * An entry is a header holding the SHA-256 digest and length of the source text it was parsed
+ * from, followed by the `.meowb` image of the parse. Its name is made of the digest, the binary
+ * format version, the parser version and the optimisation level, and the header is checked against
+ * the source before the image is used; anything unreadable or mismatched just falls back to parsing.
+ * Entries are written to a temporary file named after the process and thread and renamed into
+ * place, so concurrent runs never see half-written files.
+ *
+ * The directory is $MEOW_CACHE_DIR, else $XDG_CACHE_HOME/meow-vm, else ~/.cache/meow-vm.
+ * Setting MEOW_NO_CACHE (or passing --no-cache) disables the cache.
+ */
+class CompileCache {
+public:
+    /// @brief Part of every entry name; there are no bytecode optimisation passes yet
+    static constexpr Uint32 OPTIMIZATION_LEVEL = 0;
+
+    CompileCache();
+
+    void setEnabled(Bool enabled) noexcept { enabled_ = enabled; }
+    [[nodiscard]] Bool enabled() const noexcept { return enabled_ && !directory.empty(); }
+
+    /// @brief Parsed form of the text module at `path`, taken from the cache when its source is unchanged.
+    /// Safe to call from several threads, each with its own parser
+    ParsedModule readFile(const Str& path, BytecodeParser& parser) const;
+private:
+    std::filesystem::path directory;
+    Bool enabled_ = true;
+
+    using Digest = std::array<Uint8, 32>;
+
+    std::filesystem::path entryFor(const Digest& digest) const;
+    void store(const std::filesystem::path& entry, const Digest& digest, Uint64 sourceSize, const ParsedModule& module) const;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "core/objects.h"
+
+class MemoryManager;
+
+/**
+ * @brief Loads modules with empty function bodies, filling each one in the first time it is needed.
+ *
+ * Only the name, register count and upvalue count of every function are read up front; a body is
+ * decoded from the mapped file when its proto is first turned into a closure (see
+ * ObjFunctionProto::loadBody). `.meowb` images already index their functions; text modules get
+ * one scan for `.func` blocks, and each body is parsed on its own later. Errors inside a body
+ * therefore surface when that function is first used rather than at load time.
+ */
+class LazyModuleLoader {
+public:
+    std::unordered_map<std::string, Proto> protos;
+    LazyModuleLoader() = default;
+    Bool parseTextFile(const std::string& filepath, MemoryManager& mm);
+    Bool parseBinaryFile(const std::string& filepath, MemoryManager& mm);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+
+/**
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ * Pages are only faulted in when touched. Where mapping fails (or on platforms without mmap) the
+ * file is read into an owned buffer instead, so callers never need to tell the two apart.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile() { close(); }
+
+    /// @brief Maps `path`. Returns false (and stays empty) if it cannot be opened
+    Bool open(const Str& path);
+    void close() noexcept;
+
+    [[nodiscard]] const char* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::string_view view() const noexcept { return { data_, size_ }; }
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    Bool mapped_ = false;
+    std::vector<char> buffer_;
+};
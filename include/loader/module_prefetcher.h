@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common/pch.h"
+#include "bytecode_parser.h"
+#include "module_resolver.h"
+#include "compile_cache.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Parses imported source modules on background threads before execution reaches them.
+ *
+ * When a module is parsed, its IMPORT_MODULE paths are resolved and queued; workers read and parse
+ * those files (or take them from the compile cache) into GC-free ParsedModules and queue their imports in turn, so a whole dependency
+ * tree is parsed in parallel. The VM thread picks results up with take() and allocates the
+ * protos itself, so the GC is never touched off the VM thread.
+ */
+class ModulePrefetcher {
+public:
+    ModulePrefetcher(ModuleResolver& resolver, const CompileCache& cache) : resolver(resolver), cache(cache) {}
+    ModulePrefetcher(const ModulePrefetcher&) = delete;
+    ModulePrefetcher& operator=(const ModulePrefetcher&) = delete;
+    ~ModulePrefetcher();
+
+    /// @brief Queues the source modules named by `imports` (as written in the module at `importer`)
+    void prefetchImports(const std::vector<Str>& imports, const Str& importer);
+    /// @brief The parsed module at `path` if it was queued, waiting for it if still in flight.
+    /// Each path is handed out once; nullopt means the caller must parse it itself
+    std::optional<ParsedModule> take(const Str& path);
+private:
+    struct Task {
+        ParsedModule parsed;
+        Bool done = false;
+        Bool taken = false;
+    };
+
+    ModuleResolver& resolver;
+    const CompileCache& cache;
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable finished;
+    std::deque<Str> pending;
+    std::unordered_map<Str, std::unique_ptr<Task>> tasks;  // kept after take() so nothing is parsed twice
+    std::vector<std::thread> workers;
+    Bool stopping = false;
+
+    void work();
+};
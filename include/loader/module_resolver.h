@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+
+#include <mutex>
+#include <unordered_set>
+
+struct ImportTraceStats {
+    Uint64 lookups = 0;
+    Uint64 cached = 0;
+    Uint64 nanoseconds = 0;
+};
+
+/**
+ * @brief Maps import specs to files on disk.
+ *
+ * Native libraries are searched for under the stdlib root (and its lib/, stdlib/, bin/ variants)
+ * before the importer's directory. Instead of one stat per candidate, each directory is listed once
+ * and kept as a set of names, and every answer, found or not, is cached by (importer dir, spec).
+ * Files added to a searched directory while the VM runs are therefore not seen.
+ * Safe to call from several threads (the import prefetcher resolves off the VM thread).
+ */
+class ModuleResolver {
+public:
+    explicit ModuleResolver(Str entryPointDir = ".") : entryPointDir(std::move(entryPointDir)) {}
+
+    /// @brief Absolute path of the native library `spec` imported from `importer`, or "" if it is not one
+    Str resolveLibrary(const Str& spec, const Str& importer);
+    /// @brief Absolute, normalised path of the source module `spec` imported from `importer`
+    Str resolveSource(const Str& spec, const Str& importer);
+
+    /// @brief Prints every resolution and its cost to stderr
+    void setTracing(Bool enabled) noexcept { tracing = enabled; }
+    ImportTraceStats getTraceStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+private:
+    Str entryPointDir;
+    mutable std::mutex mutex;
+    std::unordered_map<Str, Str> resolved;                            // "kind\0dir\0spec" -> path ("" = not found)
+    std::unordered_map<Str, std::unordered_set<Str>> directories;     // dir -> names of its regular files
+    std::vector<std::filesystem::path> searchRoots;
+    Bool searchRootsReady = false;
+    Bool tracing = false;
+    ImportTraceStats stats;
+
+    std::filesystem::path importerDir(const Str& importer) const;
+    /// @brief Whether `path` is a regular file. Each directory is listed once, on its first probe, and the
+    /// listing is kept for the resolver's lifetime like the resolutions themselves
+    Bool isFile(const std::filesystem::path& path);
+    const std::vector<std::filesystem::path>& stdlibSearchRoots();
+    Str findLibrary(const Str& spec, const std::filesystem::path& baseDir);
+
+    template <typename Resolve>
+    Str lookup(char kind, const Str& spec, const Str& importer, Resolve&& resolve);
+};
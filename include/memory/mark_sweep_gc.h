@@ -13,6 +13,9 @@ struct GCMetadata {
 class MarkSweepGC : public GarbageCollector, public GCVisitor {
 private:
     std::unordered_map<const MeowObject*, GCMetadata> metadata;
+    // Marked objects whose children are not traced yet. Keeps marking iterative, so long
+    // chains (e.g. ropes built by repeated concatenation) cannot overflow the native stack
+    std::vector<const MeowObject*> grayStack;
     MeowVM* vm = nullptr;
 
 public:
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/pch.h"
+#include "core/value.h"
+
+/**
+ * @brief Bulk numeric kernels behind the typed array natives.
+ *
+ * Every entry point is bound on first use to an AVX2, SSE2 or scalar body, depending on what
+ * the running CPU supports, so one binary is fast on new machines and still runs on old ones.
+ * Float sums and dot products accumulate in several lanes at once, so their rounding may differ
+ * from a plain left-to-right loop in the last bits. Integer arithmetic wraps on overflow.
+ * Float min/max are both NaN if any element is NaN, on every instruction set.
+ */
+
+enum class CompareOp : Uint8 { LT, LE, GT, GE, EQ, NE };
+
+// --- Reductions ---
+[[nodiscard]] Real typed_sum_f64(const Real* data, size_t count) noexcept;
+[[nodiscard]] Int typed_sum_i64(const Int* data, size_t count) noexcept;
+/// @brief Requires count > 0
+void typed_min_max_f64(const Real* data, size_t count, Real& min, Real& max) noexcept;
+/// @brief Requires count > 0
+void typed_min_max_i64(const Int* data, size_t count, Int& min, Int& max) noexcept;
+[[nodiscard]] Real typed_dot_f64(const Real* a, const Real* b, size_t count) noexcept;
+[[nodiscard]] Int typed_dot_i64(const Int* a, const Int* b, size_t count) noexcept;
+
+// --- Element-wise (out may alias an input) ---
+void typed_scale_f64(Real* out, const Real* in, Real factor, size_t count) noexcept;
+void typed_scale_i64(Int* out, const Int* in, Int factor, size_t count) noexcept;
+void typed_add_f64(Real* out, const Real* a, const Real* b, size_t count) noexcept;
+void typed_add_i64(Int* out, const Int* a, const Int* b, size_t count) noexcept;
+
+/// @brief out[i] = (in[i] <op> operand) ? 1 : 0
+void typed_compare_f64(Int* out, const Real* in, Real operand, CompareOp op, size_t count) noexcept;
+void typed_compare_i64(Int* out, const Int* in, Int operand, CompareOp op, size_t count) noexcept;
+
+/// @brief Name of the instruction set the kernels were bound to ("avx2", "sse2" or "scalar")
+[[nodiscard]] const char* typed_kernels_isa() noexcept;
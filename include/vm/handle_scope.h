@@ -0,0 +1,37 @@
+#pragma once
+
+#include "meow_engine.h"
+
+/**
+ * @brief Roots every value created through it until the scope is destroyed.
+ *
+ * Natives hold raw `Value`s the collector cannot see, so anything that must
+ * survive a later allocation inside the same native has to be rooted here:
+ *
+ *     HandleScope scope(engine);
+ *     Array parts = scope.root(engine->get_heap()->newObject<ObjArray>());
+ *
+ * Scopes nest and must be destroyed in LIFO order (which RAII guarantees).
+ */
+class HandleScope {
+private:
+    MeowEngine* engine_;
+    size_t mark_;
+public:
+    explicit HandleScope(MeowEngine* engine) noexcept : engine_(engine), mark_(engine->handle_scope_begin()) {}
+    HandleScope(const HandleScope&) = delete;
+    HandleScope& operator=(const HandleScope&) = delete;
+    HandleScope(HandleScope&&) = delete;
+    HandleScope& operator=(HandleScope&&) = delete;
+    ~HandleScope() noexcept { engine_->handle_scope_end(mark_); }
+
+    /// @brief Roots a value. The returned reference stays valid until the scope closes
+    inline Value& root(const Value& value) { return engine_->make_handle(value); }
+
+    /// @brief Roots a freshly allocated object and hands the pointer back unchanged
+    template <typename T, typename = std::enable_if_t<std::is_pointer_v<T>>>
+    inline T root(T object) {
+        engine_->make_handle(Value(object));
+        return object;
+    }
+};
@@ -5,13 +5,31 @@
 class Value;
 class MemoryManager;
 
+/// @brief One entry of a register_methods / register_getters table
+struct NativeBinding {
+    std::string_view name;
+    Value function;
+};
+
 class MeowEngine {
 public:
     virtual ~MeowEngine() = default;
 
     virtual Value call(const Value& callee, Arguments args) = 0;
+    /// @brief Same, with the arguments written in place: `call(getter, { receiver })`
+    Value call(const Value& callee, std::initializer_list<Value> args) { return call(callee, Arguments(args.begin(), args.size())); }
     virtual MemoryManager* get_heap() noexcept = 0;
     virtual void register_method(const std::string& type_name, const std::string& method_name, const Value& method) = 0;
     virtual void register_getter(const std::string& type_name, const std::string& property_name, const Value& getter) = 0;
     virtual const std::vector<std::string>& get_arguments() const noexcept = 0;
+
+    // --- Handle scopes (see handle_scope.h) ---
+    virtual size_t handle_scope_begin() noexcept = 0;
+    virtual void handle_scope_end(size_t mark) noexcept = 0;
+    virtual Value& make_handle(const Value& value) = 0;
+
+    // Appended after the older entries so that native libraries built against them keep their vtable layout
+    /// @brief Registers a whole table of methods (or getters) of one type at once
+    virtual void register_methods(const std::string& type_name, std::initializer_list<NativeBinding> methods) = 0;
+    virtual void register_getters(const std::string& type_name, std::initializer_list<NativeBinding> getters) = 0;
 };
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
 #include "core/objects.h"
 #include "bytecode_parser.h"
+#include "binary_parser.h"
+#include "lazy_loader.h"
+#include "module_resolver.h"
+#include "module_prefetcher.h"
 #include "operator_dispatcher.h"
 #include "memory_manager.h"
 #include "meow_engine.h"
+#include "native_module_registry.h"
+#include "handle_scope.h"
 #include "common/pch.h"
 
 class VMError : public std::runtime_error {
@@ -11,39 +17,75 @@ public:
     VMError(const Str& m) : std::runtime_error(m) {}
 };
 
-class GCScopeGuard {
-private:
-    MemoryManager* mm;
-public:
-    GCScopeGuard(MemoryManager* mem) : mm(mem) { if(mm) mm->disableGC(); }
-    ~GCScopeGuard() { if(mm) mm->enableGC(); }
-};
-
 class GCVisitor;
 
+struct InlineCacheStats {
+    Uint64 hits = 0;
+    Uint64 misses = 0;
+};
+
 class MeowVM: public MeowEngine {
 public:
     MeowVM(const Str& entryPointDir);
     MeowVM(const Str& entryPointDir, int argc, char* argv[]);
     void interpret(const Str& entryPath, Bool isBinary);
-    std::vector<Value*> findRoots();
+    /// @brief Continues a program from a snapshot written by --snapshot-create (see snapshot.cpp)
+    void resume(const Str& snapshotFile);
     void traceRoots(GCVisitor&);
+    const InlineCacheStats& getInlineCacheStats() const noexcept { return icStats; }
+    void setTraceImports(Bool enabled) noexcept { moduleResolver.setTracing(enabled); }
+    void setCompileCacheEnabled(Bool enabled) noexcept { compileCache.setEnabled(enabled); }
+    /// @brief Load function bodies on first use instead of with their module (see LazyModuleLoader)
+    void setLazyLoading(Bool enabled) noexcept { lazyLoading = enabled; }
+    /// @brief Caps the register file at `slots` values; calls that need more throw a stack overflow.
+    /// The whole capacity is reserved up front, so call before running anything. Throws VMError above MAX_STACK_SLOTS
+    void setStackLimit(Int slots);
+    /// @brief 16M slots, a few hundred megabytes reserved; anything larger is almost certainly a typo
+    static constexpr Int MAX_STACK_SLOTS = Int{1} << 24;
+    ImportTraceStats getImportTraceStats() const { return moduleResolver.getTraceStats(); }
+    /// @brief Write a snapshot to `path` and stop when the program calls snapshot_point().
+    /// Call before running anything, so every native can be named in the snapshot
+    void setSnapshotOutput(const Str& path);
+    [[nodiscard]] Bool hasWrittenSnapshot() const noexcept { return snapshotWritten; }
 
 private:
+    friend class SnapshotWriter;
+    friend class SnapshotReader;
+
     std::vector<CallFrame> callStack;
+    /// @brief Natives get views into stackSlots, so it is reserved once, stackLimit slots, and never reallocated.
+    /// 64K slots are a few megabytes and thousands of nested calls; --stack-slots raises it
+    static constexpr Int DEFAULT_STACK_SLOTS = Int{1} << 16;
+    Int stackLimit = DEFAULT_STACK_SLOTS;
     std::vector<Value> stackSlots;
     std::vector<Upvalue> openUpvalues;
     std::vector<Str> commandLineArgs;
     std::unordered_map<Str, Module> moduleCache;
+    Module builtinScope = nullptr;  // the "native" module, built once and shared by every loaded module
     std::unordered_map<Module, std::unordered_map<Str, Value>> moduleGlobals;
     std::unordered_map<Str, std::unordered_map<Str, Value>> builtinMethods;
     std::unordered_map<Str, std::unordered_map<Str, Value>> builtinGetters;
     
     std::vector<ExceptionHandler> exceptionHandlers;
+    std::deque<Value> handleStack;
     BytecodeParser textParser;
+    BinaryParser binaryParser;
+    LazyModuleLoader lazyLoader;
+    Bool lazyLoading = false;
+    ModuleResolver moduleResolver;
+    CompileCache compileCache;
+    ModulePrefetcher modulePrefetcher{moduleResolver, compileCache};
     OperatorDispatcher opDispatcher;
     std::unique_ptr<MemoryManager> memoryManager;
     Str entryPointDir;
+    InlineCacheStats icStats;
+    Uint64 classEpoch = 0;
+    Int linkedExportCount = 0;  // export numbers of the linked program being run; EXPORT ignores larger operands
+    std::vector<Str> nativeLibraries;  // loaded with _loadNativeLibrary, in load order
+    Str snapshotPath;
+    Bool snapshotPending = false;
+    Bool snapshotWritten = false;
+    Int nestedCalls = 0;  // depth of call() made by natives
 
     using OpCodeHandler = void (MeowVM::*)();
     std::vector<OpCodeHandler> jumpTable;
@@ -53,22 +95,57 @@ private:
     Int currentBase = 0;
 
     void defineNativeFunctions();
+    void defineTypedArrayNatives(std::unordered_map<Str, Value>& natives);
+    void defineStringNatives();
     Module _getOrLoadModule(const Str& modulePath, const Str& importerPath, Bool isBinary);
+    Module _loadNativeLibrary(const Str& libPath);
+    /// @brief Loads every module of a `.meowl` program (see binary_format.h) into the module cache; returns the entry module
+    Module _loadLinkedProgram(const Str& path);
+    /// @brief `method` (or `getter`) as it should be stored: tagged with its key while a snapshot is to be written
+    Value _snapshotMethod(const Str& type, const Str& name, const Value& method) const;
+    Value _snapshotGetter(const Str& type, const Str& name, const Value& getter) const;
+    void _tagLibraryNatives(Module library, const Str& libPath);
+    void _writeSnapshot();
+    void _loadBody(Proto proto);
     void run();
     void initializeJumpTable();
     void _handleRuntimeException(const VMError& e);
     void closeUpvalues(Int slotIndex);
     Upvalue captureUpvalue(Int slotIndex);
-    void _executeCall(const Value& callee, Int dst, Int argStart, Int argc, Int base);
+    /// @brief Starts a call from the frame at `base`; `freeFrom` is the CALL's planned window (-1 copies the arguments)
+    void _executeCall(const Value& callee, Int dst, Int argStart, Int argc, Int base, Int freeFrom = -1);
+    /// @brief Makes room for a callee with `leading` registers before its arguments and returns its first slot
+    Int _openCallWindow(Int numRegisters, Int base, Int argStart, Int argc, Int freeFrom, Int leading);
+    /// @brief Grows stackSlots to at least `size` slots, or throws once the register file is full
+    void _growStack(Int size);
+    /// @brief Sets stackSlots to exactly `size` slots; growing goes through _growStack
+    void _setStackTop(Int size);
+    /// @brief Calls a native; `receiver` is what a method was looked up on, or null for a plain call
+    Value _callNative(const NativeFn& native, const Value* receiver, Arguments args);
+    /// @brief The native leg of a CALL: runs `native` on the caller's argument registers, stores the result
+    /// in `dst` and takes a pending snapshot. Shared by CALL and the GET_PROP fast path that skips the binding
+    void _finishNativeCall(const NativeFn& native, const Value* receiver, Int dst, Int argStart, Int argc, Int base);
 
     MemoryManager* get_heap() noexcept override { return this->memoryManager.get(); }
+    using MeowEngine::call;
     Value call(const Value& callee, Arguments args) override;
-    void register_method(const Str& type_name, const Str& method_name, const Value& method) noexcept override;
-    void register_getter(const Str& type_name, const Str& property_name, const Value& getter) noexcept override;
+    void register_method(const Str& type_name, const Str& method_name, const Value& method) override;
+    void register_getter(const Str& type_name, const Str& property_name, const Value& getter) override;
+    void register_methods(const Str& type_name, std::initializer_list<NativeBinding> methods) override;
+    void register_getters(const Str& type_name, std::initializer_list<NativeBinding> getters) override;
     const std::vector<Str>& get_arguments() const noexcept override { return commandLineArgs; }
+    size_t handle_scope_begin() noexcept override { return handleStack.size(); }
+    void handle_scope_end(size_t mark) noexcept override { handleStack.resize(mark); }
+    Value& make_handle(const Value& value) override { return handleStack.emplace_back(value); }
 
     Function wrapClosure(const Value& maybeCallable);
     std::optional<Value> getMagicMethod(const Value& obj, const Str& name);
+    Value _callGetter(const Value& getter, const Value& receiver);
+    /// @brief The native method `name` of a non-instance value, unless a field or getter of that name shadows it
+    const Value* _findBuiltinMethod(const Value& obj, const Str& name);
+    std::optional<Value> findClassMethod(Class klass, const Str& name);
+    Value bindMethod(Instance inst, const Value& method);
+    Value concatStrings(const Value& left, const Value& right);
     
     void opMove();
     void opLoadConst();
@@ -96,6 +173,8 @@ private:
     void opSetIndex();
     void opGetKeys();
     void opGetValues();
+    void opIterInit();
+    void opIterNext();
     void opNewClass();
     void opNewInstance();
     void opGetProp();
@@ -117,6 +196,11 @@ private:
     Int _toInt(const Value& v) const;
     Real _toDouble(const Value& v) const;
     Bool _isTruthy(const Value& v) const;
+    void _flattenRope(Value& v);
+    const Value& _charValue(char c) const noexcept;
+    void _promoteString(Value& v);
+    const Utf8Index& _utf8Index(const Value& v, Utf8Index& scratch);
+    std::string_view _stringView(const Value& v);
     Bool _areValuesEqual(const Value& a, const Value& b) const;
     
     Str opToString(OpCode op) const;
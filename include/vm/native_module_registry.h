@@ -0,0 +1,47 @@
+#pragma once
+
+#include "meow_engine.h"
+#include "common/pch.h"
+
+struct ObjModule;
+
+using NativeModuleFactory = ObjModule* (*)(MeowEngine*);
+
+/**
+ * @brief Native modules linked into the executable, by import name.
+ *
+ * `import "<name>"` consults this before any filesystem lookup, so a statically linked stdlib
+ * module never costs a directory probe or a dlopen. Modules register at static initialisation
+ * with MEOW_NATIVE_MODULE; shared-library builds keep going through `CreateMeowModule` instead.
+ */
+class NativeModuleRegistry {
+public:
+    static void add(const std::string& name, NativeModuleFactory factory) { modules().insert_or_assign(name, factory); }
+    /// @brief Factory registered under `name`, or nullptr
+    [[nodiscard]] static NativeModuleFactory find(const std::string& name) {
+        auto& all = modules();
+        auto it = all.find(name);
+        return it != all.end() ? it->second : nullptr;
+    }
+private:
+    // Function-local so that registrations from other translation units never run before it exists
+    static std::unordered_map<std::string, NativeModuleFactory>& modules() {
+        static std::unordered_map<std::string, NativeModuleFactory> registered;
+        return registered;
+    }
+};
+
+struct NativeModuleRegistration {
+    NativeModuleRegistration(const char* name, NativeModuleFactory factory) { NativeModuleRegistry::add(name, factory); }
+};
+
+#define MEOW_NATIVE_MODULE_CONCAT_(a, b) a##b
+#define MEOW_NATIVE_MODULE_CONCAT(a, b) MEOW_NATIVE_MODULE_CONCAT_(a, b)
+
+/// @brief Registers `factory` as the native module imported as `name` when the stdlib is linked statically
+#if defined(MEOW_STD_STATIC)
+#define MEOW_NATIVE_MODULE(name, factory) \
+    static const NativeModuleRegistration MEOW_NATIVE_MODULE_CONCAT(meowNativeModule_, __COUNTER__){ name, factory }
+#else
+#define MEOW_NATIVE_MODULE(name, factory) static_assert(true, "loaded through CreateMeowModule")
+#endif
@@ -0,0 +1,255 @@
+#include "core/objects.h"
+#include "memory_manager.h"
+
+#include <bit>
+
+void ObjFunctionProto::trace(GCVisitor& visitor) const noexcept {
+    for (auto& constant : constantPool) {
+        visitor.visit_value(constant);
+    }
+    for (auto& cache : propertyCaches) {
+        for (size_t i = 0; i < cache.count; ++i) {
+            visitor.visit_object(cache.entries[i].shape);
+            visitor.visit_object(cache.entries[i].transition);
+            visitor.visit_value(cache.entries[i].method);
+        }
+    }
+    visitor.visit_object(linkedModule);
+    visitor.visit_object(lazyBody);
+}
+
+Bool ObjFunctionProto::loadBody(Str& error) {
+    if (!lazyBody->load(*this, error)) return false;
+    lazyBody = nullptr;
+    attachInlineCaches();
+    if (linkedModule) linkedModule->link(this);
+    return true;
+}
+
+void ObjFunctionProto::planCallWindows() {
+    for (auto& inst : code) {
+        if (inst.op == OpCode::CALL) inst.firstDead = -1;
+    }
+    // A catch block may read any register, and its entry is not an edge of the flow graph
+    if (numRegisters <= 0 || code.empty()) return;
+    for (auto& inst : code) {
+        if (inst.op == OpCode::SETUP_TRY) return;
+    }
+
+    // Backward liveness over register bitsets: liveIn = uses | (liveOut & ~defs)
+    const size_t words = (static_cast<size_t>(numRegisters) + 63) / 64;
+    const Int count = static_cast<Int>(code.size());
+    std::vector<Uint64> liveIn(static_cast<size_t>(count) * words, 0);
+    std::vector<Uint64> set(words);
+
+    auto arg = [](const Instruction& inst, size_t i) -> Int { return i < inst.args.size() ? inst.args[i] : -1; };
+    auto use = [&](Int reg) {
+        if (reg >= 0 && reg < numRegisters) set[static_cast<size_t>(reg) >> 6] |= Uint64{1} << (reg & 63);
+    };
+    auto useRange = [&](Int first, Int n) {
+        for (Int reg = std::max<Int>(first, 0); reg < first + n && reg < numRegisters; ++reg) use(reg);
+    };
+    auto def = [&](Int reg) {
+        if (reg >= 0 && reg < numRegisters) set[static_cast<size_t>(reg) >> 6] &= ~(Uint64{1} << (reg & 63));
+    };
+    auto liveOut = [&](Int i) {
+        std::fill(set.begin(), set.end(), 0);
+        auto join = [&](Int target) {
+            if (target < 0 || target >= count) return;
+            const Uint64* in = &liveIn[static_cast<size_t>(target) * words];
+            for (size_t w = 0; w < words; ++w) set[w] |= in[w];
+        };
+        const Instruction& inst = code[i];
+        switch (inst.op) {
+            case OpCode::JUMP: join(arg(inst, 0)); break;
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE: join(i + 1); join(arg(inst, 1)); break;
+            case OpCode::ITER_NEXT: join(i + 1); join(arg(inst, 3)); break;
+            case OpCode::RETURN:
+            case OpCode::HALT:
+            case OpCode::THROW: break;
+            default: join(i + 1); break;
+        }
+    };
+    auto transfer = [&](const Instruction& inst) {
+        switch (inst.op) {
+            case OpCode::LOAD_CONST: case OpCode::LOAD_NULL: case OpCode::LOAD_TRUE: case OpCode::LOAD_FALSE:
+            case OpCode::LOAD_INT: case OpCode::GET_GLOBAL: case OpCode::GET_UPVALUE: case OpCode::NEW_CLASS:
+            case OpCode::IMPORT_MODULE:
+                def(arg(inst, 0));
+                break;
+            case OpCode::GET_SUPER:
+                def(arg(inst, 0));
+                use(0);
+                break;
+            case OpCode::MOVE: case OpCode::NEG: case OpCode::NOT: case OpCode::BIT_NOT: case OpCode::GET_KEYS:
+            case OpCode::GET_VALUES: case OpCode::NEW_INSTANCE: case OpCode::GET_PROP: case OpCode::GET_EXPORT:
+            case OpCode::GET_MODULE_EXPORT:
+                def(arg(inst, 0));
+                use(arg(inst, 1));
+                break;
+            case OpCode::ADD: case OpCode::SUB: case OpCode::MUL: case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+            case OpCode::EQ: case OpCode::NEQ: case OpCode::GT: case OpCode::GE: case OpCode::LT: case OpCode::LE:
+            case OpCode::BIT_AND: case OpCode::BIT_OR: case OpCode::BIT_XOR: case OpCode::LSHIFT: case OpCode::RSHIFT:
+            case OpCode::GET_INDEX:
+                def(arg(inst, 0));
+                use(arg(inst, 1));
+                use(arg(inst, 2));
+                break;
+            case OpCode::SET_GLOBAL: case OpCode::SET_UPVALUE: case OpCode::EXPORT:
+                use(arg(inst, 1));
+                break;
+            case OpCode::SET_INDEX:
+                use(arg(inst, 0));
+                use(arg(inst, 1));
+                use(arg(inst, 2));
+                break;
+            case OpCode::SET_PROP: case OpCode::SET_METHOD:
+                use(arg(inst, 0));
+                use(arg(inst, 2));
+                break;
+            case OpCode::INHERIT:
+                use(arg(inst, 0));
+                use(arg(inst, 1));
+                break;
+            case OpCode::JUMP_IF_FALSE: case OpCode::JUMP_IF_TRUE: case OpCode::RETURN: case OpCode::THROW:
+            case OpCode::IMPORT_ALL:
+                use(arg(inst, 0));
+                break;
+            case OpCode::CALL:
+                def(arg(inst, 0));
+                use(arg(inst, 1));
+                useRange(arg(inst, 2), arg(inst, 3));
+                break;
+            case OpCode::NEW_ARRAY:
+                def(arg(inst, 0));
+                useRange(arg(inst, 1), arg(inst, 2));
+                break;
+            case OpCode::NEW_HASH:
+                def(arg(inst, 0));
+                useRange(arg(inst, 1), arg(inst, 2) * 2);
+                break;
+            case OpCode::CLOSURE: {
+                def(arg(inst, 0));
+                Int idx = arg(inst, 1);
+                Proto child = (idx >= 0 && idx < static_cast<Int>(constantPool.size()) && constantPool[idx].is_proto())
+                    ? constantPool[idx].get<Proto>() : nullptr;
+                // Until the child's body is loaded its captures are unknown
+                if (!child || !child->isLoaded()) {
+                    useRange(0, numRegisters);
+                    break;
+                }
+                for (auto& desc : child->upvalueDescs) {
+                    if (desc.isLocal) use(desc.index);
+                }
+                break;
+            }
+            case OpCode::ITER_INIT:
+                def(arg(inst, 0));
+                def(arg(inst, 0) + 1);
+                def(arg(inst, 0) + 2);
+                use(arg(inst, 1));
+                break;
+            case OpCode::ITER_NEXT:
+                useRange(arg(inst, 2), 3);
+                break;
+            case OpCode::JUMP: case OpCode::HALT: case OpCode::CLOSE_UPVALUES: case OpCode::POP_TRY:
+                break;
+            default:
+                useRange(0, numRegisters);
+                break;
+        }
+    };
+
+    for (Bool changed = true; changed;) {
+        changed = false;
+        for (Int i = count - 1; i >= 0; --i) {
+            liveOut(i);
+            transfer(code[i]);
+            Uint64* in = &liveIn[static_cast<size_t>(i) * words];
+            if (!std::equal(set.begin(), set.end(), in)) {
+                std::copy(set.begin(), set.end(), in);
+                changed = true;
+            }
+        }
+    }
+
+    for (Int i = 0; i < count; ++i) {
+        if (code[i].op != OpCode::CALL) continue;
+        liveOut(i);
+        Int firstDead = 0;
+        for (size_t w = words; w-- > 0;) {
+            if (set[w]) {
+                firstDead = static_cast<Int>(w * 64 + 64 - std::countl_zero(set[w]));
+                break;
+            }
+        }
+        code[i].firstDead = firstDead;
+    }
+}
+
+const Value* ObjClass::findMethod(const Str& name, Uint64 epoch) {
+    if (resolvedEpoch != epoch) {
+        // Nearest definition wins, so walk from this class upwards and never overwrite
+        resolvedMethods.clear();
+        for (Class cur = this; cur; cur = cur->superclass ? *cur->superclass : nullptr) {
+            for (auto& method : cur->methods) {
+                resolvedMethods.emplace(method.first, method.second);
+            }
+        }
+        resolvedEpoch = epoch;
+    }
+    auto it = resolvedMethods.find(name);
+    return it != resolvedMethods.end() ? &it->second : nullptr;
+}
+
+void ObjInstance::setField(const Str& key, const Value& value, MemoryManager& heap) {
+    if (Value* field = getField(key)) {
+        *field = value;
+        return;
+    }
+
+    if (!dictionary && (!klass || (shape && shape->slotCount >= MAX_SHAPE_SLOTS))) {
+        toDictionary();
+    }
+    if (dictionary) {
+        (*dictionary)[Value(key)] = value;
+        return;
+    }
+
+    // Shapes are shared by every instance of the class that added the same properties in the same order
+    Shape from = shape;
+    if (!from) {
+        if (!klass->instanceShape) klass->instanceShape = heap.newObject<ObjShape>();
+        from = klass->instanceShape;
+    }
+    Shape next = nullptr;
+    if (auto it = from->transitions.find(key); it != from->transitions.end()) {
+        next = it->second;
+    } else {
+        next = heap.newObject<ObjShape>(from, key);
+        from->transitions.emplace(key, next);
+    }
+    appendSlot(next, value);
+}
+
+bool ObjInstance::removeField(const Str& key) {
+    if (!getField(key)) return false;
+    toDictionary();
+    dictionary->erase(Value(key));
+    return true;
+}
+
+void ObjInstance::toDictionary() {
+    if (dictionary) return;
+    auto fields = std::make_unique<ValueTable>();
+    fields->reserve(fieldCount());
+    forEachField([&](const Str& name, const Value& value) {
+        (*fields)[Value(name)] = value;
+    });
+    dictionary = std::move(fields);
+    shape = nullptr;
+    inlineSlots.fill(Value(Null{}));
+    extraSlots.clear();
+    extraSlots.shrink_to_fit();
+}
@@ -0,0 +1,145 @@
+#include "core/utf8.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MEOW_UTF8_X86 1
+#define MEOW_UTF8_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#else
+#define MEOW_UTF8_X86 0
+#endif
+
+// --- ASCII runs ---
+
+static size_t asciiPrefixScalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) ++i;
+    return i;
+}
+
+#if MEOW_UTF8_X86
+
+static size_t asciiPrefixSse2(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+    return i + asciiPrefixScalar(data + i, size - i);
+}
+
+MEOW_UTF8_AVX2 static size_t asciiPrefixAvx2(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        int mask = _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+    return i + asciiPrefixSse2(data + i, size - i);
+}
+
+#endif // MEOW_UTF8_X86
+
+using ascii_prefix_fn_t = size_t (*)(const char*, size_t) noexcept;
+
+static ascii_prefix_fn_t selectAsciiPrefix() noexcept {
+#if MEOW_UTF8_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return asciiPrefixAvx2;
+    return asciiPrefixSse2;
+#else
+    return asciiPrefixScalar;
+#endif
+}
+
+size_t utf8_ascii_prefix(const char* data, size_t size) noexcept {
+    static const ascii_prefix_fn_t body = selectAsciiPrefix();
+    return body(data, size);
+}
+
+// --- Validation ---
+
+/// @brief Length of the well-formed sequence at `p`, or 0 if there is none
+static size_t utf8SequenceLength(const unsigned char* p, size_t remaining) noexcept {
+    auto continuation = [](unsigned char b) { return (b & 0xC0) == 0x80; };
+    unsigned char b = p[0];
+    if (b < 0x80) return 1;
+    if (b < 0xC2) return 0;  // stray continuation byte, or overlong 2-byte form
+    if (b < 0xE0) return remaining >= 2 && continuation(p[1]) ? 2 : 0;
+    if (b < 0xF0) {
+        if (remaining < 3 || !continuation(p[1]) || !continuation(p[2])) return 0;
+        if (b == 0xE0 && p[1] < 0xA0) return 0;   // overlong
+        if (b == 0xED && p[1] >= 0xA0) return 0;  // UTF-16 surrogate
+        return 3;
+    }
+    if (b < 0xF5) {
+        if (remaining < 4 || !continuation(p[1]) || !continuation(p[2]) || !continuation(p[3])) return 0;
+        if (b == 0xF0 && p[1] < 0x90) return 0;   // overlong
+        if (b == 0xF4 && p[1] >= 0x90) return 0;  // past U+10FFFF
+        return 4;
+    }
+    return 0;
+}
+
+bool utf8_validate(const char* data, size_t size) noexcept {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t i = 0;
+    while (true) {
+        i += utf8_ascii_prefix(data + i, size - i);
+        if (i == size) return true;
+        size_t length = utf8SequenceLength(bytes + i, size - i);
+        if (length == 0) return false;
+        i += length;
+    }
+}
+
+// --- Character index ---
+
+Utf8Index::Utf8Index(std::string_view s) {
+    size_t ascii = utf8_ascii_prefix(s.data(), s.size());
+    if (ascii == s.size() || !utf8_validate(s.data() + ascii, s.size() - ascii)) {
+        length_ = s.size();
+        return;
+    }
+    byteIndexed_ = false;
+    checkpoints_.reserve(s.size() / STRIDE + 1);
+
+    // Every byte that is not a continuation byte starts a character
+    size_t i = 0;
+#if MEOW_UTF8_X86
+    const __m128i lastContinuation = _mm_set1_epi8(static_cast<char>(0xBF));
+    for (; i + 16 <= s.size(); i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + i));
+        unsigned starts = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, lastContinuation)));
+        size_t count = static_cast<size_t>(__builtin_popcount(starts));
+        // A chunk holds at most 16 characters, so at most one checkpoint can fall inside it
+        size_t phase = length_ % STRIDE;
+        if (phase != 0 && phase + count <= STRIDE) {
+            length_ += count;
+            continue;
+        }
+        for (; starts; starts &= starts - 1) {
+            if (length_ % STRIDE == 0) checkpoints_.push_back(i + static_cast<size_t>(__builtin_ctz(starts)));
+            ++length_;
+        }
+    }
+#endif
+    for (; i < s.size(); ++i) {
+        if ((static_cast<unsigned char>(s[i]) & 0xC0) == 0x80) continue;
+        if (length_ % STRIDE == 0) checkpoints_.push_back(i);
+        ++length_;
+    }
+}
+
+void Utf8Index::replaced(std::string_view s, size_t index, size_t oldWidth, std::string_view replacement) {
+    // A byte index (ASCII or malformed text) may have to become a code point index, and a malformed
+    // replacement makes the text malformed; both are rare enough to rebuild
+    if (byteIndexed_ || !utf8_validate(replacement.data(), replacement.size())) {
+        *this = Utf8Index(s);
+        return;
+    }
+    // One whole character for another keeps the text valid and the count the same; only the
+    // checkpoints past the write move
+    if (replacement.size() == oldWidth) return;
+    for (size_t k = index / STRIDE + 1; k < checkpoints_.size(); ++k) {
+        checkpoints_[k] = checkpoints_[k] + replacement.size() - oldWidth;
+    }
+}
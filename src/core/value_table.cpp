@@ -0,0 +1,131 @@
+#include "core/value_table.h"
+
+#include <bit>
+
+const void* ValueTable::identityOf(const Value& v) noexcept {
+    if (auto p = v.get_if<Array>()) return *p;
+    if (auto p = v.get_if<Object>()) return *p;
+    if (auto p = v.get_if<Instance>()) return *p;
+    if (auto p = v.get_if<Class>()) return *p;
+    if (auto p = v.get_if<Upvalue>()) return *p;
+    if (auto p = v.get_if<Function>()) return *p;
+    if (auto p = v.get_if<Module>()) return *p;
+    if (auto p = v.get_if<BoundMethod>()) return *p;
+    if (auto p = v.get_if<Proto>()) return *p;
+    if (auto p = v.get_if<TypedArray>()) return *p;
+    return nullptr;
+}
+
+size_t ValueTable::hashOf(const Value& key) noexcept {
+    if (auto s = key.get_if<Str>()) return hashString(*s);
+
+    Uint64 bits = 0;
+    if (auto i = key.get_if<Int>()) bits = static_cast<Uint64>(*i);
+    else if (auto r = key.get_if<Real>()) bits = std::bit_cast<Uint64>(*r);
+    else if (auto b = key.get_if<Bool>()) bits = *b ? 1 : 0;
+    else bits = reinterpret_cast<uintptr_t>(identityOf(key));
+    // Salt with the type so that e.g. 1 and true land in different places
+    return static_cast<size_t>(mix(bits + static_cast<Uint64>(key.index()) * 0x9e3779b97f4a7c15ULL)) & HASH_MASK;
+}
+
+bool ValueTable::keyEquals(const Value& a, const Value& b) noexcept {
+    if (a.index() != b.index()) return false;
+    if (auto s = a.get_if<Str>()) return *s == b.get<Str>();
+    if (auto i = a.get_if<Int>()) return *i == b.get<Int>();
+    if (auto r = a.get_if<Real>()) return std::bit_cast<Uint64>(*r) == std::bit_cast<Uint64>(b.get<Real>());
+    if (auto v = a.get_if<Bool>()) return *v == b.get<Bool>();
+    if (a.is_null()) return true;
+    return identityOf(a) == identityOf(b);
+}
+
+size_t ValueTable::findFreeSlot(size_t hash) const noexcept {
+    size_t mask = groupMask();
+    size_t group = (hash >> 7) & mask;
+    for (size_t step = 1;; ++step) {
+        if (Uint32 m = matchEmptyOrDeleted(&ctrl_[group * GROUP_WIDTH])) {
+            return group * GROUP_WIDTH + static_cast<size_t>(__builtin_ctz(m));
+        }
+        group = (group + step) & mask;
+    }
+}
+
+size_t ValueTable::insertEntry(const Value& key, size_t hash) {
+    size_t slot = findSlot(key, hash);
+    if (slot != NPOS) return indexAt(slot);
+
+    // Every used control byte is backed by an entry (live or erased), so bounding
+    // the entries array also bounds the probe load
+    if (entries_.size() >= usable()) {
+        if (capacity_ == 0) rehash(GROUP_WIDTH);
+        else if (size_ < usable() / 2) rehash(capacity_);  // mostly holes: compact in place
+        else rehash(capacity_ * 2);
+    }
+
+    size_t index = entries_.size();
+    entries_.push_back({ key, Value(), hash });
+    slot = findFreeSlot(hash);
+    ctrl_[slot] = h2(hash);
+    setIndexAt(slot, index);
+    ++size_;
+    return index;
+}
+
+void ValueTable::rehash(size_t newCapacity) {
+    Uint8 width = newCapacity <= 256 ? 1 : newCapacity <= 65536 ? 2 : 4;
+    auto ctrl = std::make_unique<ctrl_t[]>(newCapacity);
+    auto indices = std::make_unique<Uint8[]>(newCapacity * width);
+    std::fill_n(ctrl.get(), newCapacity, CTRL_EMPTY);
+
+    // Squeeze out erased entries while keeping insertion order
+    std::vector<Entry> entries;
+    entries.reserve(newCapacity * 7 / 8);
+    for (Entry& entry : entries_) {
+        if (!(entry.hash & ERASED)) entries.push_back(std::move(entry));
+    }
+
+    entries_ = std::move(entries);
+    ctrl_ = std::move(ctrl);
+    indices_ = std::move(indices);
+    capacity_ = newCapacity;
+    width_ = width;
+
+    // Hashes are cached in the entries, so nothing gets rehashed from its key
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        size_t slot = findFreeSlot(entries_[i].hash);
+        ctrl_[slot] = h2(entries_[i].hash);
+        setIndexAt(slot, i);
+    }
+}
+
+bool ValueTable::erase(const Value& key) {
+    if (const Real* r = key.get_if<Real>(); r && isIntegral(*r)) return erase(Value(static_cast<Int>(*r)));
+    size_t slot = findSlot(key, hashOf(key));
+    if (slot == NPOS) return false;
+
+    // Probes stop at the first group holding an EMPTY byte, so if this group already has one
+    // no probe ever ran past it and the slot can go straight back to EMPTY
+    const ctrl_t* group = &ctrl_[slot & ~(GROUP_WIDTH - 1)];
+    ctrl_[slot] = matchByte(group, CTRL_EMPTY) ? CTRL_EMPTY : CTRL_DELETED;
+
+    Entry& entry = entries_[indexAt(slot)];
+    entry.key = Value();
+    entry.value = Value();
+    entry.hash |= ERASED;
+    --size_;
+    return true;
+}
+
+void ValueTable::reserve(size_t count) {
+    size_t capacity = GROUP_WIDTH;
+    while (capacity * 7 / 8 < count) capacity *= 2;
+    if (capacity > capacity_) rehash(capacity);
+}
+
+void ValueTable::clear() noexcept {
+    entries_.clear();
+    entries_.shrink_to_fit();
+    ctrl_.reset();
+    indices_.reset();
+    capacity_ = size_ = 0;
+    width_ = 1;
+}
@@ -0,0 +1,100 @@
+#include "binary_parser.h"
+#include "mapped_file.h"
+#include "memory_manager.h"
+
+Bool BinaryParser::parseFile(const Str& filepath, MemoryManager& mm) {
+    MappedFile file;
+    if (!file.open(filepath)) {
+        std::cerr << "Error: Cannot open file: " << filepath << std::endl;
+        return false;
+    }
+    return parseImage(file.view(), filepath, mm);
+}
+
+Bool BinaryParser::parseImage(std::string_view bytes, const Str& sourceName, MemoryManager& mm) {
+    protos.clear();
+    auto fail = [&](const Str& what) {
+        std::cerr << "Error in '" << sourceName << "': " << what << std::endl;
+        protos.clear();
+        return false;
+    };
+
+    BinaryModuleView image;
+    Str error;
+    if (!image.open(bytes, error)) return fail(error);
+
+    std::vector<Proto> byIndex;
+    if (!allocateProtos(image, mm, protos, byIndex, error)) return fail(error);
+    for (Uint32 i = 0; i < byIndex.size(); ++i) {
+        if (!loadBody(image, i, byIndex, *byIndex[i], error)) return fail(error);
+    }
+    // Only once every body is in, since call windows look at the protos CLOSURE refers to
+    for (Proto proto : byIndex) proto->attachInlineCaches();
+    return true;
+}
+
+Bool BinaryParser::allocateProtos(const BinaryModuleView& image, MemoryManager& mm, std::unordered_map<Str, Proto>& protos, std::vector<Proto>& byIndex, Str& error) {
+    // Every proto exists before any body is read, so PROTO constants can point at any of them.
+    // Each one is rooted through `protos` as soon as it exists
+    const BinaryHeader& header = image.header();
+    byIndex.assign(header.protoCount, nullptr);
+    for (Uint32 i = 0; i < header.protoCount; ++i) {
+        const BinaryProto& record = image.proto(i);
+        std::string_view name;
+        if (!image.string(record.name, name)) {
+            error = "tên hàm không hợp lệ";
+            return false;
+        }
+        Str key(name);
+        byIndex[i] = mm.newObject<ObjFunctionProto>(static_cast<Int>(record.numRegisters), static_cast<Int>(record.numUpvalues), key);
+        protos[key] = byIndex[i];
+    }
+    return true;
+}
+
+Bool BinaryParser::loadBody(const BinaryModuleView& image, Uint32 index, const std::vector<Proto>& byIndex, ObjFunctionProto& proto, Str& error) {
+    const BinaryProto& record = image.proto(index);
+    auto fail = [&](const Str& what) {
+        error = what;
+        return false;
+    };
+
+    const BinaryConstant* constants;
+    const BinaryUpvalue* upvalues;
+    if (!image.sections(record, constants, upvalues)) return fail("dữ liệu của hàm '" + proto.sourceName + "' nằm ngoài file");
+
+    proto.constantPool.reserve(record.constantCount);
+    for (Uint32 c = 0; c < record.constantCount; ++c) {
+        const BinaryConstant& constant = constants[c];
+        switch (constant.tag) {
+            case BinaryConstantTag::NUL: proto.constantPool.emplace_back(Null{}); break;
+            case BinaryConstantTag::INT: proto.constantPool.emplace_back(static_cast<Int>(constant.payload)); break;
+            case BinaryConstantTag::REAL: proto.constantPool.emplace_back(std::bit_cast<Real>(constant.payload)); break;
+            case BinaryConstantTag::BOOL: proto.constantPool.emplace_back(constant.payload != 0); break;
+            case BinaryConstantTag::STRING: {
+                std::string_view s;
+                if (constant.payload < 0 || !image.string(static_cast<Uint64>(constant.payload), s)) return fail("hằng chuỗi không hợp lệ");
+                proto.constantPool.emplace_back(Str(s));
+                break;
+            }
+            case BinaryConstantTag::PROTO:
+                if (constant.payload < 0 || static_cast<Uint64>(constant.payload) >= byIndex.size()) return fail("tham chiếu hàm không hợp lệ");
+                proto.constantPool.emplace_back(byIndex[constant.payload]);
+                break;
+            default:
+                return fail("loại hằng số không hợp lệ");
+        }
+    }
+
+    proto.upvalueDescs.reserve(record.upvalueCount);
+    for (Uint32 u = 0; u < record.upvalueCount; ++u) {
+        proto.upvalueDescs.emplace_back(upvalues[u].isLocal != 0, static_cast<Int>(upvalues[u].index));
+    }
+
+    proto.code.reserve(record.instructionCount);
+    Bool decoded = image.decodeCode(record, [&](OpCode op, std::vector<Int>&& args) {
+        proto.code.emplace_back(op, std::move(args));
+    });
+    if (!decoded) return fail("mã lệnh của hàm '" + proto.sourceName + "' bị hỏng");
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "binary_format.h"
+#include "bytecode_parser.h"
+
+Bool BinaryModuleView::open(std::string_view image, Str& error) {
+    bytes_ = image;
+    header_ = section<BinaryHeader>(0, 1);
+    if (!header_ || std::memcmp(header_->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+        error = "không phải file .meowb";
+        return false;
+    }
+    if (header_->version != BINARY_VERSION) {
+        error = "phiên bản .meowb " + std::to_string(header_->version) + " không được hỗ trợ (cần " + std::to_string(BINARY_VERSION) + ")";
+        return false;
+    }
+    if (header_->fileSize != bytes_.size()) {
+        error = "file .meowb bị cắt cụt hoặc hỏng";
+        return false;
+    }
+    strings_ = section<BinaryString>(header_->stringsOffset, header_->stringCount);
+    protos_ = section<BinaryProto>(header_->protosOffset, header_->protoCount);
+    if (!strings_ || !protos_) {
+        error = "bảng chuỗi hoặc bảng hàm nằm ngoài file";
+        return false;
+    }
+    return true;
+}
+
+Bool BinaryModuleView::string(Uint64 index, std::string_view& out) const noexcept {
+    if (index >= header_->stringCount) return false;
+    const BinaryString& s = strings_[index];
+    if (s.offset > bytes_.size() || s.length > bytes_.size() - s.offset) return false;
+    out = bytes_.substr(s.offset, s.length);
+    return true;
+}
+
+Bool BinaryModuleView::sections(const BinaryProto& record, const BinaryConstant*& constants, const BinaryUpvalue*& upvalues) const noexcept {
+    constants = section<BinaryConstant>(record.constantsOffset, record.constantCount);
+    upvalues = section<BinaryUpvalue>(record.upvaluesOffset, record.upvalueCount);
+    return constants && upvalues;
+}
+
+Bool readBinaryModule(std::string_view image, ParsedModule& out, Str& error) {
+    static const Str PROTO_PREFIX = "::function_proto::";
+    BinaryModuleView view;
+    if (!view.open(image, error)) return false;
+    const BinaryHeader& header = view.header();
+
+    std::vector<std::string_view> names(header.protoCount);
+    for (Uint32 i = 0; i < header.protoCount; ++i) {
+        if (!view.string(view.proto(i).name, names[i])) {
+            error = "tên hàm không hợp lệ";
+            return false;
+        }
+    }
+
+    out = ParsedModule{};
+    for (Uint32 i = 0; i < header.protoCount; ++i) {
+        const BinaryProto& record = view.proto(i);
+        ParsedFunction& function = out.functions[Str(names[i])];
+        function.numRegisters = static_cast<Int>(record.numRegisters);
+        function.numUpvalues = static_cast<Int>(record.numUpvalues);
+
+        const BinaryConstant* constants;
+        const BinaryUpvalue* upvalues;
+        if (!view.sections(record, constants, upvalues)) {
+            error = "dữ liệu của hàm '" + Str(names[i]) + "' nằm ngoài file";
+            return false;
+        }
+        function.constantPool.reserve(record.constantCount);
+        for (Uint32 c = 0; c < record.constantCount; ++c) {
+            const BinaryConstant& constant = constants[c];
+            std::string_view s;
+            switch (constant.tag) {
+                case BinaryConstantTag::NUL: function.constantPool.emplace_back(Null{}); break;
+                case BinaryConstantTag::INT: function.constantPool.emplace_back(static_cast<Int>(constant.payload)); break;
+                case BinaryConstantTag::REAL: function.constantPool.emplace_back(std::bit_cast<Real>(constant.payload)); break;
+                case BinaryConstantTag::BOOL: function.constantPool.emplace_back(constant.payload != 0); break;
+                case BinaryConstantTag::STRING:
+                    if (constant.payload < 0 || !view.string(static_cast<Uint64>(constant.payload), s)) {
+                        error = "hằng chuỗi không hợp lệ";
+                        return false;
+                    }
+                    function.constantPool.emplace_back(Str(s));
+                    break;
+                case BinaryConstantTag::PROTO:
+                    if (constant.payload < 0 || static_cast<Uint64>(constant.payload) >= header.protoCount) {
+                        error = "tham chiếu hàm không hợp lệ";
+                        return false;
+                    }
+                    function.constantPool.emplace_back(PROTO_PREFIX + Str(names[constant.payload]));
+                    break;
+                default:
+                    error = "loại hằng số không hợp lệ";
+                    return false;
+            }
+        }
+        function.upvalueDescs.reserve(record.upvalueCount);
+        for (Uint32 u = 0; u < record.upvalueCount; ++u) {
+            function.upvalueDescs.emplace_back(upvalues[u].isLocal != 0, static_cast<Int>(upvalues[u].index));
+        }
+        function.code.reserve(record.instructionCount);
+        Bool decoded = view.decodeCode(record, [&](OpCode op, std::vector<Int>&& args) {
+            function.code.emplace_back(op, std::move(args));
+        });
+        if (!decoded) {
+            error = "mã lệnh của hàm '" + Str(names[i]) + "' bị hỏng";
+            return false;
+        }
+    }
+    BytecodeParser::collectImports(out);
+    return true;
+}
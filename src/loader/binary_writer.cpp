@@ -0,0 +1,162 @@
+#include "binary_format.h"
+#include "bytecode_parser.h"
+
+#include <cstring>
+#include <map>
+
+namespace {
+    class BinaryBuilder {
+    public:
+        std::vector<char>& out;
+        explicit BinaryBuilder(std::vector<char>& out) : out(out) {}
+
+        Uint32 offset() const noexcept { return static_cast<Uint32>(out.size()); }
+        void align() { out.resize((out.size() + 7) & ~size_t(7), '\0'); }
+        Uint32 append(const void* data, size_t size) {
+            Uint32 at = offset();
+            out.insert(out.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+            return at;
+        }
+        Uint32 reserve(size_t size) {
+            Uint32 at = offset();
+            out.resize(out.size() + size, '\0');
+            return at;
+        }
+        template <typename T>
+        void patch(Uint32 at, const T& record) { std::memcpy(out.data() + at, &record, sizeof(T)); }
+    };
+}
+
+Bool writeBinaryModule(const ParsedModule& module, std::vector<char>& out, Str& error) {
+    // Sorted so that the same source always produces the same bytes
+    std::map<Str, const ParsedFunction*> sorted;
+    for (const auto& [name, function] : module.functions) sorted.emplace(name, &function);
+    std::unordered_map<Str, Uint32> protoIndex;
+    std::vector<BinaryFunction> functions;
+    for (const auto& [name, function] : sorted) {
+        protoIndex.emplace(name, static_cast<Uint32>(functions.size()));
+        functions.push_back({ &name, function, &protoIndex });
+    }
+    auto main = protoIndex.find("@main");
+    return writeBinaryImage(functions, main != protoIndex.end() ? main->second : BINARY_NO_INDEX, {}, out, error);
+}
+
+Bool writeBinaryImage(const std::vector<BinaryFunction>& functions, Uint32 mainProto, const std::vector<Str>& leadingStrings,
+                      std::vector<char>& out, Str& error) {
+    static const Str PROTO_PREFIX = "::function_proto::";
+    out.clear();
+    BinaryBuilder builder(out);
+
+    std::vector<Str> strings;
+    std::unordered_map<Str, Uint32> stringIndex;
+    auto intern = [&](const Str& s) {
+        auto [it, inserted] = stringIndex.try_emplace(s, static_cast<Uint32>(strings.size()));
+        if (inserted) strings.push_back(s);
+        return it->second;
+    };
+    for (const Str& s : leadingStrings) intern(s);
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.mainProto = mainProto;
+    builder.reserve(sizeof(BinaryHeader));
+
+    header.protoCount = static_cast<Uint32>(functions.size());
+    header.protosOffset = builder.reserve(sizeof(BinaryProto) * functions.size());
+
+    // Offset of each constant pool written so far, keyed by its records; a linked image repeats many
+    std::unordered_map<std::string, Uint32> pools;
+    Uint32 protoSlot = header.protosOffset;
+    for (const auto& [namePtr, function, protoIndex] : functions) {
+        const Str& name = *namePtr;
+        BinaryProto record{};
+        record.name = intern(name);
+        record.numRegisters = static_cast<Uint32>(function->numRegisters);
+        record.numUpvalues = static_cast<Uint32>(function->numUpvalues);
+
+        record.constantCount = static_cast<Uint32>(function->constantPool.size());
+        std::string pool;
+        pool.reserve(sizeof(BinaryConstant) * function->constantPool.size());
+        for (const Value& constant : function->constantPool) {
+            BinaryConstant c{};
+            if (constant.is_null()) {
+                c.tag = BinaryConstantTag::NUL;
+            } else if (constant.is_int()) {
+                c.tag = BinaryConstantTag::INT;
+                c.payload = constant.get<Int>();
+            } else if (constant.is_real()) {
+                c.tag = BinaryConstantTag::REAL;
+                c.payload = std::bit_cast<Int64>(constant.get<Real>());
+            } else if (constant.is_bool()) {
+                c.tag = BinaryConstantTag::BOOL;
+                c.payload = constant.get<Bool>() ? 1 : 0;
+            } else if (constant.is_string()) {
+                const Str& s = constant.get<Str>();
+                auto target = s.rfind(PROTO_PREFIX, 0) == 0 ? protoIndex->find(s.substr(PROTO_PREFIX.size())) : protoIndex->end();
+                if (target != protoIndex->end()) {
+                    c.tag = BinaryConstantTag::PROTO;
+                    c.payload = target->second;
+                } else {
+                    c.tag = BinaryConstantTag::STRING;
+                    c.payload = intern(s);
+                }
+            } else {
+                error = "Hằng số không biểu diễn được trong .meowb ở hàm '" + name + "'";
+                return false;
+            }
+            pool.append(reinterpret_cast<const char*>(&c), sizeof(c));
+        }
+        builder.align();
+        auto [pooled, isNew] = pools.try_emplace(std::move(pool), builder.offset());
+        if (isNew) builder.append(pooled->first.data(), pooled->first.size());
+        record.constantsOffset = pooled->second;
+
+        record.upvaluesOffset = builder.offset();
+        record.upvalueCount = static_cast<Uint32>(function->upvalueDescs.size());
+        for (const UpvalueDesc& desc : function->upvalueDescs) {
+            BinaryUpvalue u{ desc.isLocal ? 1u : 0u, static_cast<Uint32>(desc.index) };
+            builder.append(&u, sizeof(u));
+        }
+
+        record.codeOffset = builder.offset();
+        record.instructionCount = static_cast<Uint32>(function->code.size());
+        for (const Instruction& inst : function->code) {
+            Uint16 head[2] = { static_cast<Uint16>(inst.op), static_cast<Uint16>(inst.args.size()) };
+            if (inst.args.size() > 0xFFFF) {
+                error = "Lệnh có quá nhiều tham số ở hàm '" + name + "'";
+                return false;
+            }
+            builder.append(head, sizeof(head));
+            for (Int arg : inst.args) {
+                if (arg < std::numeric_limits<Int32>::min() || arg > std::numeric_limits<Int32>::max()) {
+                    error = "Tham số " + std::to_string(arg) + " vượt quá Int32 ở hàm '" + name + "'";
+                    return false;
+                }
+                Int32 narrow = static_cast<Int32>(arg);
+                builder.append(&narrow, sizeof(narrow));
+            }
+        }
+        record.codeSize = builder.offset() - record.codeOffset;
+
+        builder.patch(protoSlot, record);
+        protoSlot += sizeof(BinaryProto);
+    }
+
+    builder.align();
+    header.stringCount = static_cast<Uint32>(strings.size());
+    header.stringsOffset = builder.reserve(sizeof(BinaryString) * strings.size());
+    for (size_t i = 0; i < strings.size(); ++i) {
+        BinaryString entry{ builder.append(strings[i].data(), strings[i].size()), static_cast<Uint32>(strings[i].size()) };
+        builder.patch(header.stringsOffset + static_cast<Uint32>(i * sizeof(BinaryString)), entry);
+    }
+
+    builder.align();
+    if (out.size() > std::numeric_limits<Uint32>::max()) {
+        error = "Module quá lớn cho định dạng .meowb";
+        return false;
+    }
+    header.fileSize = builder.offset();
+    builder.patch(0, header);
+    return true;
+}
@@ -1,224 +1,374 @@
 #include "bytecode_parser.h"
 #include "memory_manager.h"
+#include "mapped_file.h"
 #include "common/pch.h"
 
-static Str trim(const Str& s) {
-    size_t a = s.find_first_not_of(" \t\r\n");
-    if (a == Str::npos) return "";
-    size_t b = s.find_last_not_of(" \t\r\n");
-    return s.substr(a, b - a + 1);
-}
+#include <charconv>
+
+// --- Lexing: every token is a view into the source buffer ---
 
-static Str toUpper(const Str& s) {
-    Str res = s;
-    std::transform(res.begin(), res.end(), res.begin(), ::toupper);
-    return res;
+static inline bool isBlank(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
 }
 
-static inline void skipComment(Str& line) {
-    bool in_string = false;
-    size_t comment_pos = Str::npos;
+static inline std::string_view trimView(std::string_view s) noexcept {
+    size_t a = 0, b = s.size();
+    while (a < b && isBlank(s[a])) ++a;
+    while (b > a && isBlank(s[b - 1])) --b;
+    return s.substr(a, b - a);
+}
 
-    for (size_t i = 0; i < line.length(); ++i) {
-        if (line[i] == '"') {
-            if (i == 0 || line[i-1] != '\\') {
-                in_string = !in_string;
-            }
+/// @brief `line` up to its first '#' outside a string literal, trimmed
+static inline std::string_view stripComment(std::string_view line) noexcept {
+    bool inString = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '"' && (i == 0 || line[i - 1] != '\\')) {
+            inString = !inString;
+        } else if (line[i] == '#' && !inString) {
+            return trimView(line.substr(0, i));
         }
-        
-        if (line[i] == '#' && !in_string) {
-            comment_pos = i;
-            break;
+    }
+    return trimView(line);
+}
+
+/// @brief Parses the whole token as a decimal integer. Jump operands that fail this are labels
+static inline bool parseInteger(std::string_view token, Int& out) noexcept {
+    const char* first = token.data();
+    const char* last = first + token.size();
+    const bool plus = first != last && *first == '+';
+    if (plus) ++first;
+    // from_chars takes its own '-', so "+-5" would otherwise slip through
+    if (first == last || *first == '+' || (plus && *first == '-')) return false;
+    auto [ptr, ec] = std::from_chars(first, last, out);
+    return ec == std::errc() && ptr == last;
+}
+
+static inline bool parseReal(std::string_view token, Real& out) noexcept {
+    const char* last = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), last, out);
+    return ec == std::errc() && ptr == last && !token.empty();
+}
+
+// --- Opcode mnemonics: case-insensitive perfect hash built at compile time ---
+
+namespace {
+    struct Mnemonic {
+        std::string_view name;
+        OpCode op;
+    };
+}
+
+static constexpr Mnemonic MNEMONICS[] = {
+    {"LOAD_CONST", OpCode::LOAD_CONST}, {"LOAD_NULL", OpCode::LOAD_NULL}, {"LOAD_TRUE", OpCode::LOAD_TRUE},
+    {"LOAD_FALSE", OpCode::LOAD_FALSE}, {"LOAD_INT", OpCode::LOAD_INT}, {"MOVE", OpCode::MOVE},
+    {"ADD", OpCode::ADD}, {"SUB", OpCode::SUB}, {"MUL", OpCode::MUL}, {"DIV", OpCode::DIV},
+    {"MOD", OpCode::MOD}, {"POW", OpCode::POW}, {"EQ", OpCode::EQ}, {"NEQ", OpCode::NEQ},
+    {"GT", OpCode::GT}, {"GE", OpCode::GE}, {"LT", OpCode::LT}, {"LE", OpCode::LE},
+    {"NEG", OpCode::NEG}, {"NOT", OpCode::NOT}, {"GET_GLOBAL", OpCode::GET_GLOBAL},
+    {"SET_GLOBAL", OpCode::SET_GLOBAL}, {"GET_UPVALUE", OpCode::GET_UPVALUE}, {"SET_UPVALUE", OpCode::SET_UPVALUE},
+    {"CLOSURE", OpCode::CLOSURE}, {"CLOSE_UPVALUES", OpCode::CLOSE_UPVALUES}, {"JUMP", OpCode::JUMP},
+    {"JUMP_IF_FALSE", OpCode::JUMP_IF_FALSE}, {"JUMP_IF_TRUE", OpCode::JUMP_IF_TRUE}, {"CALL", OpCode::CALL}, {"RETURN", OpCode::RETURN},
+    {"HALT", OpCode::HALT}, {"NEW_ARRAY", OpCode::NEW_ARRAY}, {"NEW_HASH", OpCode::NEW_HASH},
+    {"GET_INDEX", OpCode::GET_INDEX}, {"SET_INDEX", OpCode::SET_INDEX}, {"GET_KEYS", OpCode::GET_KEYS}, {"GET_VALUES", OpCode::GET_VALUES}, {"NEW_CLASS", OpCode::NEW_CLASS},
+    {"NEW_INSTANCE", OpCode::NEW_INSTANCE}, {"GET_PROP", OpCode::GET_PROP}, {"SET_PROP", OpCode::SET_PROP},
+    {"SET_METHOD", OpCode::SET_METHOD}, {"INHERIT", OpCode::INHERIT}, {"GET_SUPER", OpCode::GET_SUPER}, {"BIT_AND", OpCode::BIT_AND},
+    {"BIT_OR", OpCode::BIT_OR}, {"BIT_XOR", OpCode::BIT_XOR}, {"BIT_NOT", OpCode::BIT_NOT},
+    {"LSHIFT", OpCode::LSHIFT}, {"RSHIFT", OpCode::RSHIFT}, {"THROW", OpCode::THROW},
+    {"SETUP_TRY", OpCode::SETUP_TRY}, {"POP_TRY", OpCode::POP_TRY}, {"IMPORT_MODULE", OpCode::IMPORT_MODULE},
+    {"EXPORT", OpCode::EXPORT}, {"GET_EXPORT", OpCode::GET_EXPORT}, {"GET_MODULE_EXPORT", OpCode::GET_MODULE_EXPORT}, {"IMPORT_ALL", OpCode::IMPORT_ALL},
+    {"ITER_INIT", OpCode::ITER_INIT}, {"ITER_NEXT", OpCode::ITER_NEXT}
+};
+static_assert(std::size(MNEMONICS) == static_cast<size_t>(OpCode::TOTAL_OPCODES), "every opcode needs a mnemonic");
+
+static constexpr size_t MNEMONIC_TABLE_SIZE = 256;
+
+static constexpr char upperAscii(char c) noexcept {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+static constexpr Uint32 mnemonicHash(std::string_view s, Uint32 seed) noexcept {
+    Uint32 h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(upperAscii(c));
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 16)) % MNEMONIC_TABLE_SIZE;
+}
+
+/// @brief First seed under which no two mnemonics share a slot
+static constexpr Uint32 findMnemonicSeed() {
+    for (Uint32 seed = 0; seed < 100000; ++seed) {
+        std::array<bool, MNEMONIC_TABLE_SIZE> used{};
+        bool collision = false;
+        for (const Mnemonic& m : MNEMONICS) {
+            Uint32 slot = mnemonicHash(m.name, seed);
+            if (used[slot]) { collision = true; break; }
+            used[slot] = true;
         }
+        if (!collision) return seed;
+    }
+    return ~Uint32(0);
+}
+
+static constexpr Uint32 MNEMONIC_SEED = findMnemonicSeed();
+static_assert(MNEMONIC_SEED != ~Uint32(0), "no collision-free seed for the mnemonic table");
+
+// Slot -> index + 1 into MNEMONICS, 0 when empty
+static constexpr auto MNEMONIC_SLOTS = [] {
+    std::array<Uint8, MNEMONIC_TABLE_SIZE> slots{};
+    for (size_t i = 0; i < std::size(MNEMONICS); ++i) {
+        slots[mnemonicHash(MNEMONICS[i].name, MNEMONIC_SEED)] = static_cast<Uint8>(i + 1);
     }
+    return slots;
+}();
 
-    if (comment_pos != Str::npos) {
-        line = line.substr(0, comment_pos);
+static inline bool lookupMnemonic(std::string_view token, OpCode& op) noexcept {
+    Uint8 entry = MNEMONIC_SLOTS[mnemonicHash(token, MNEMONIC_SEED)];
+    if (entry == 0) return false;
+    const Mnemonic& m = MNEMONICS[entry - 1];
+    if (m.name.size() != token.size()) return false;
+    for (size_t i = 0; i < token.size(); ++i) {
+        if (upperAscii(token[i]) != m.name[i]) return false;
     }
-    line = trim(line);
+    op = m.op;
+    return true;
 }
 
 
 Bool BytecodeParser::parseFile(const Str& filepath, MemoryManager& mm) {
-    this->memoryManager = &mm;
-    std::ifstream ifs(filepath);
-    if (!ifs) {
-        std::cerr << "Error: Cannot open file: " << filepath << std::endl;
+    return materialize(readFile(filepath), mm);
+}
+
+Bool BytecodeParser::parseSource(const Str& source, const Str& sourceName, MemoryManager& mm) {
+    return materialize(read(source, sourceName), mm);
+}
+
+ParsedModule BytecodeParser::readFile(const Str& filepath) {
+    MappedFile file;
+    if (!file.open(filepath)) {
+        ParsedModule failed;
+        failed.error = "Error: Cannot open file: " + filepath;
+        return failed;
+    }
+    return read(file.view(), filepath);
+}
+
+Bool BytecodeParser::materialize(ParsedModule&& parsed, MemoryManager& mm) {
+    protos.clear();
+    if (!parsed.error.empty()) {
+        std::cerr << parsed.error << std::endl;
         return false;
     }
-    std::ostringstream ss;
-    ss << ifs.rdbuf();
-    Bool res = parseSource(ss.str(), filepath);
-    this->memoryManager = nullptr;
-    return res;
+    for (auto& [name, function] : parsed.functions) {
+        Proto proto = mm.newObject<ObjFunctionProto>(function.numRegisters, function.numUpvalues, name);
+        fillProto(std::move(function), *proto);
+        protos[name] = proto;
+    }
+    linkProtos();
+    return true;
+}
+
+void BytecodeParser::split(std::string_view line) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && isBlank(line[i])) ++i;
+        size_t start = i;
+        while (i < line.size() && !isBlank(line[i])) ++i;
+        if (i > start) tokens.push_back(line.substr(start, i - start));
+    }
+}
+
+void BytecodeParser::fillProto(ParsedFunction&& function, ObjFunctionProto& proto) {
+    proto.numRegisters = function.numRegisters;
+    proto.numUpvalues = function.numUpvalues;
+    proto.code = std::move(function.code);
+    proto.constantPool = std::move(function.constantPool);
+    proto.upvalueDescs = std::move(function.upvalueDescs);
+    proto.labels = std::move(function.labels);
 }
 
-std::vector<Str> BytecodeParser::split(const Str& s) {
-    std::istringstream iss(s);
-    std::vector<Str> out;
-    Str tok;
-    while (std::getline(iss, tok)) {
-        std::istringstream iss2(tok);
-        Str sub_tok;
-        while (iss2 >> sub_tok) {
-            out.push_back(sub_tok);
+ScannedModule BytecodeParser::scan(std::string_view source, const Str& sourceName) {
+    ScannedModule scanned;
+    FunctionExtent* open = nullptr;
+    Int lineno = 0;
+    size_t pos = 0;
+    auto fail = [&](const Str& what) {
+        scanned.error = "Semantic error in '" + sourceName + "' at line " + std::to_string(lineno) + ": " + what;
+        return scanned;
+    };
+    while (pos < source.size()) {
+        size_t begin = pos;
+        size_t end = source.find('\n', pos);
+        if (end == std::string_view::npos) end = source.size();
+        pos = end + 1;
+        ++lineno;
+        // Only directives matter here; instructions and labels are left for when the body is loaded
+        std::string_view line = trimView(source.substr(begin, end - begin));
+        if (line.empty() || line.front() != '.') continue;
+        line = stripComment(line);
+        if (line.empty() || line.back() == ':') continue;
+        split(line);
+
+        std::string_view cmd = tokens[0];
+        Int value = 0;
+        if (cmd == ".func") {
+            if (open) return fail("Không thể bắt đầu .func mới trong một .func khác.");
+            if (tokens.size() < 2) return fail(".func yêu cầu tên hàm.");
+            open = &scanned.functions.emplace_back();
+            open->name = Str(tokens[1]);
+            open->begin = begin;
+            open->firstLine = lineno;
+        } else if (cmd == ".endfunc") {
+            if (!open) return fail("Cannot find any .endfunc corresponding to .func.");
+            open->end = std::min(pos, source.size());
+            open = nullptr;
+        } else if (cmd == ".registers" || cmd == ".upvalues") {
+            if (!open) return fail("'" + Str(cmd) + "' directive must be inside a .func block.");
+            if (tokens.size() < 2 || !parseInteger(tokens[1], value)) return fail("'" + Str(cmd) + "' cần tham số là số nguyên.");
+            (cmd == ".registers" ? open->numRegisters : open->numUpvalues) = value;
         }
     }
-    return out;
+    if (open) scanned.error = "Error in '" + sourceName + "': file ended but missed '.endfunc'";
+    return scanned;
 }
 
-Bool BytecodeParser::parseSource(const Str& source, const Str& sourceName) {
-    protos.clear();
+ParsedModule BytecodeParser::read(std::string_view source, const Str& sourceName, Int firstLine) {
+    ParsedModule parsed;
+    module = &parsed;
     currentProto = nullptr;
-    std::istringstream iss(source);
-    Str line;
-    Int lineno = 0;
-    while (std::getline(iss, line)) {
+    Int lineno = firstLine - 1;
+    size_t pos = 0;
+    while (pos < source.size()) {
+        size_t end = source.find('\n', pos);
+        if (end == std::string_view::npos) end = source.size();
+        std::string_view line = stripComment(source.substr(pos, end - pos));
+        pos = end + 1;
         ++lineno;
-        skipComment(line);
         if (line.empty()) continue;
         try {
-            if (!parseLine(line, sourceName, lineno)) return false;
+            parseLine(line);
         } catch (const std::exception& e) {
-            std::cerr << "Semantic error in '" << sourceName << "' at line " << lineno << ": " << e.what() << std::endl;
-            return false;
+            parsed.error = "Semantic error in '" + sourceName + "' at line " + std::to_string(lineno) + ": " + e.what();
+            break;
         }
     }
-    if (currentProto) {
-        std::cerr << "Error in '" << sourceName << "': file ended but missed '.endfunc'" << std::endl;
-        return false;
+    if (parsed.error.empty() && currentProto) {
+        parsed.error = "Error in '" + sourceName + "': file ended but missed '.endfunc'";
     }
-    try {
-        resolveAllLabels();
-        linkProtos();
-    } catch (const std::exception& e) {
-        std::cerr << "Lỗi liên kết/nhãn: " << e.what() << std::endl;
-        return false;
+    if (parsed.error.empty()) {
+        try {
+            resolveAllLabels();
+            collectImports(parsed);
+        } catch (const std::exception& e) {
+            parsed.error = Str("Lỗi liên kết/nhãn: ") + e.what();
+        }
     }
-    return true;
+    module = nullptr;
+    currentProto = nullptr;
+    return parsed;
 }
 
-Bool BytecodeParser::parseLine(const Str& line, const Str& sourceName, Int lineNumber) {
-    if (!line.empty() && line.back() == ':') {
+Bool BytecodeParser::parseLine(std::string_view line) {
+    if (line.back() == ':') {
         if (!currentProto) throw std::runtime_error("Nhãn phải nằm trong một khối .func.");
-        Str label = line.substr(0, line.size() - 1);
+        Str label(line.substr(0, line.size() - 1));
         if (currentProto->labels.count(label)) throw std::runtime_error("Nhãn '" + label + "' đã được định nghĩa.");
         currentProto->labels[label] = currentProto->code.size();
         return true;
     }
 
-    auto parts = split(line);
-    if (parts.empty()) return true;
+    split(line);
+    if (tokens.empty()) return true;
 
-    if (parts[0].size() > 0 && parts[0][0] == '.') {
-        return parseDirective(parts, sourceName, lineNumber);
+    if (tokens[0][0] == '.') {
+        return parseDirective(line);
     }
     if (!currentProto) throw std::runtime_error("Lệnh phải nằm trong một khối .func.");
 
-    static const std::unordered_map<Str, OpCode> OPC = {
-        {"LOAD_CONST", OpCode::LOAD_CONST}, {"LOAD_NULL", OpCode::LOAD_NULL}, {"LOAD_TRUE", OpCode::LOAD_TRUE},
-        {"LOAD_FALSE", OpCode::LOAD_FALSE}, {"LOAD_INT", OpCode::LOAD_INT}, {"MOVE", OpCode::MOVE},
-        {"ADD", OpCode::ADD}, {"SUB", OpCode::SUB}, {"MUL", OpCode::MUL}, {"DIV", OpCode::DIV},
-        {"MOD", OpCode::MOD}, {"POW", OpCode::POW}, {"EQ", OpCode::EQ}, {"NEQ", OpCode::NEQ},
-        {"GT", OpCode::GT}, {"GE", OpCode::GE}, {"LT", OpCode::LT}, {"LE", OpCode::LE},
-        {"NEG", OpCode::NEG}, {"NOT", OpCode::NOT}, {"GET_GLOBAL", OpCode::GET_GLOBAL},
-        {"SET_GLOBAL", OpCode::SET_GLOBAL}, {"GET_UPVALUE", OpCode::GET_UPVALUE}, {"SET_UPVALUE", OpCode::SET_UPVALUE},
-        {"CLOSURE", OpCode::CLOSURE}, {"CLOSE_UPVALUES", OpCode::CLOSE_UPVALUES}, {"JUMP", OpCode::JUMP},
-        {"JUMP_IF_FALSE", OpCode::JUMP_IF_FALSE}, {"JUMP_IF_TRUE", OpCode::JUMP_IF_TRUE}, {"CALL", OpCode::CALL}, {"RETURN", OpCode::RETURN},
-        {"HALT", OpCode::HALT}, {"NEW_ARRAY", OpCode::NEW_ARRAY}, {"NEW_HASH", OpCode::NEW_HASH},
-        {"GET_INDEX", OpCode::GET_INDEX}, {"SET_INDEX", OpCode::SET_INDEX}, {"GET_KEYS", OpCode::GET_KEYS}, {"GET_VALUES", OpCode::GET_VALUES}, {"NEW_CLASS", OpCode::NEW_CLASS},
-        {"NEW_INSTANCE", OpCode::NEW_INSTANCE}, {"GET_PROP", OpCode::GET_PROP}, {"SET_PROP", OpCode::SET_PROP},
-        {"SET_METHOD", OpCode::SET_METHOD}, {"INHERIT", OpCode::INHERIT}, {"GET_SUPER", OpCode::GET_SUPER}, {"BIT_AND", OpCode::BIT_AND},
-        {"BIT_OR", OpCode::BIT_OR}, {"BIT_XOR", OpCode::BIT_XOR}, {"BIT_NOT", OpCode::BIT_NOT},
-        {"LSHIFT", OpCode::LSHIFT}, {"RSHIFT", OpCode::RSHIFT}, {"THROW", OpCode::THROW},
-        {"SETUP_TRY", OpCode::SETUP_TRY}, {"POP_TRY", OpCode::POP_TRY}, {"IMPORT_MODULE", OpCode::IMPORT_MODULE},
-        {"EXPORT", OpCode::EXPORT}, {"GET_EXPORT", OpCode::GET_EXPORT}, {"GET_MODULE_EXPORT", OpCode::GET_MODULE_EXPORT}, {"IMPORT_ALL", OpCode::IMPORT_ALL}
-    };
-    Str upper_cmd = toUpper(parts[0]);
-    auto it = OPC.find(upper_cmd);
-    if (it == OPC.end()) throw std::runtime_error("Invalid opcode: '" + parts[0] + "'");
-    OpCode op = it->second;
-    std::vector<Int> args;
-    Int instIndex = currentProto->code.size();
+    OpCode op;
+    if (!lookupMnemonic(tokens[0], op)) throw std::runtime_error("Invalid opcode: '" + Str(tokens[0]) + "'");
+
+    // Position of the operand that may be a label, and how many operands the instruction takes then
+    size_t labelArg = 0;
+    bool hasLabel = true;
     if (op == OpCode::JUMP || op == OpCode::SETUP_TRY) {
-        if (parts.size() < 2) throw std::runtime_error("'" + parts[0] + "' command needs a label or IP index.");
-        try {
-            args.push_back(std::stoi(parts[1]));
-        } catch (...) {
-            currentProto->pendingJumps.emplace_back(instIndex, 0, parts[1]);
-            args.push_back(0);
-        }
+        if (tokens.size() < 2) throw std::runtime_error("'" + Str(tokens[0]) + "' command needs a label or IP index.");
+        labelArg = 0;
     } else if (op == OpCode::JUMP_IF_FALSE || op == OpCode::JUMP_IF_TRUE) {
-        if (parts.size() < 3) throw std::runtime_error("Lệnh '" + parts[0] + "' need 2 arguments: register and label/IP.");
-        
-        args.push_back(std::stoi(parts[1]));
-        
-        try {
-            args.push_back(std::stoi(parts[2]));
-        } catch (...) {
-            currentProto->pendingJumps.emplace_back(instIndex, 1, parts[2]);
-            args.push_back(0);
-        }
+        if (tokens.size() < 3) throw std::runtime_error("Lệnh '" + Str(tokens[0]) + "' need 2 arguments: register and label/IP.");
+        labelArg = 1;
+    } else if (op == OpCode::ITER_NEXT) {
+        if (tokens.size() < 5) throw std::runtime_error("Lệnh '" + Str(tokens[0]) + "' need 4 arguments: key, value, iterator register and label/IP.");
+        labelArg = 3;
     } else {
-        for (size_t i = 1; i < parts.size(); ++i) {
-            try {
-                args.push_back(std::stoi(parts[i]));
-            } catch (...) {
-                throw std::runtime_error("Invalid argument for '" + parts[0] + "' command. Make sure all arguments are integers.");
-            }
+        hasLabel = false;
+    }
+    size_t argc = hasLabel ? labelArg + 1 : tokens.size() - 1;
+
+    std::vector<Int> args(argc);
+    Int instIndex = currentProto->code.size();
+    for (size_t i = 0; i < argc; ++i) {
+        if (parseInteger(tokens[i + 1], args[i])) continue;
+        if (hasLabel && i == labelArg) {
+            currentProto->pendingJumps.emplace_back(instIndex, static_cast<Int>(i), Str(tokens[i + 1]));
+            args[i] = 0;
+            continue;
         }
+        throw std::runtime_error("Invalid argument for '" + Str(tokens[0]) + "' command. Make sure all arguments are integers.");
     }
-    currentProto->code.emplace_back(op, args);
+    currentProto->code.emplace_back(op, std::move(args));
     return true;
 }
 
-Bool BytecodeParser::parseDirective(const std::vector<Str>& parts, [[maybe_unused]] const Str& sourceName, [[maybe_unused]] Int lineNumber) {
-    const Str& cmd = parts[0];
+Bool BytecodeParser::parseDirective(std::string_view line) {
+    std::string_view cmd = tokens[0];
+    auto integer = [&](size_t i) {
+        Int value;
+        if (!parseInteger(tokens[i], value)) throw std::runtime_error("'" + Str(cmd) + "' cần tham số là số nguyên, nhận được '" + Str(tokens[i]) + "'.");
+        return value;
+    };
     if (cmd == ".func") {
         if (currentProto) throw std::runtime_error("Không thể bắt đầu .func mới trong một .func khác.");
-        if (parts.size() < 2) throw std::runtime_error(".func yêu cầu tên hàm.");
+        if (tokens.size() < 2) throw std::runtime_error(".func yêu cầu tên hàm.");
 
-        currentProto = memoryManager->newObject<ObjFunctionProto>(0, 0, parts[1]);
-        protos[parts[1]] = currentProto;
+        currentProto = &(module->functions[Str(tokens[1])] = ParsedFunction{});
     } else if (cmd == ".endfunc") {
         if (!currentProto) throw std::runtime_error("Cannot find any .endfunc corresponding to .func.");
         currentProto = nullptr;
     } else {
-        if (!currentProto) throw std::runtime_error("'" + cmd + "' directive must be inside a .func block.");
+        if (!currentProto) throw std::runtime_error("'" + Str(cmd) + "' directive must be inside a .func block.");
         if (cmd == ".registers") {
-            if (parts.size() < 2) throw std::runtime_error(".registers cần 1 tham số.");
-            currentProto->numRegisters = std::stoi(parts[1]);
+            if (tokens.size() < 2) throw std::runtime_error(".registers cần 1 tham số.");
+            currentProto->numRegisters = integer(1);
         } else if (cmd == ".upvalues") {
-            if (parts.size() < 2) throw std::runtime_error(".upvalues needs 1 parameter.");
-            currentProto->numUpvalues = std::stoi(parts[1]);
+            if (tokens.size() < 2) throw std::runtime_error(".upvalues needs 1 parameter.");
+            currentProto->numUpvalues = integer(1);
         } 
         else if (cmd == ".const") {
-            if (parts.size() < 2) throw std::runtime_error(".const is missing parameter.");
-            Str rest;
-            for (size_t i = 1; i < parts.size(); ++i) {
-                if (i > 1) rest += " ";
-                rest += parts[i];
-            }
-            currentProto->constantPool.push_back(parseConstValue(rest));
+            if (tokens.size() < 2) throw std::runtime_error(".const is missing parameter.");
+            // The rest of the line verbatim, so string constants keep their inner whitespace
+            currentProto->constantPool.push_back(parseConstValue(line.substr(cmd.size())));
         } else if (cmd == ".upvalue") {
-            if (parts.size() < 4) throw std::runtime_error(".upvalue yêu cầu 3 đối số.");
-            Int uvIndex = std::stoi(parts[1]);
-            Str uvType = parts[2];
-            Int slot = std::stoi(parts[3]);
+            if (tokens.size() < 4) throw std::runtime_error(".upvalue yêu cầu 3 đối số.");
+            Int uvIndex = integer(1);
+            std::string_view uvType = tokens[2];
+            Int slot = integer(3);
             Bool isLocal = (uvType == "local");
-            if (uvType != "local" && uvType != "parent_upvalue") throw std::runtime_error("Loại upvalue không hợp lệ: '" + uvType + "'.");
+            if (uvType != "local" && uvType != "parent_upvalue") throw std::runtime_error("Loại upvalue không hợp lệ: '" + Str(uvType) + "'.");
+            if (uvIndex < 0) throw std::runtime_error("Chỉ số upvalue không hợp lệ: " + std::to_string(uvIndex) + ".");
             if (currentProto->upvalueDescs.size() <= static_cast<size_t>(uvIndex)) {
                 currentProto->upvalueDescs.resize(uvIndex + 1);
             }
             currentProto->upvalueDescs[uvIndex] = UpvalueDesc(isLocal, slot);
         } else {
-            throw std::runtime_error("Chỉ thị không nhận dạng được: '" + cmd + "'");
+            throw std::runtime_error("Chỉ thị không nhận dạng được: '" + Str(cmd) + "'");
         }
     }
     return true;
 }
 
-Str unescapeString(const Str& s) {
+static Str unescapeString(std::string_view s) {
     Str result;
     result.reserve(s.length());
     bool escaping = false;
@@ -246,35 +396,32 @@ Str unescapeString(const Str& s) {
     return result;
 }
 
-Value BytecodeParser::parseConstValue(const Str& token) {
-    Str s = trim(token);
+Value BytecodeParser::parseConstValue(std::string_view token) {
+    std::string_view s = trimView(token);
     if (s.size() >= 2 && s.front() == '"' && s.back() == '"') {
-        Str inner = s.substr(1, s.size() - 2);
-        return Value(unescapeString(inner));
+        return Value(unescapeString(s.substr(1, s.size() - 2)));
     }
     if (!s.empty() && s.front() == '@') {
-        return Value("::function_proto::" + s);
+        return Value("::function_proto::" + Str(s));
     }
-    if (s.find('.') != Str::npos) {
-        try { return Value(std::stod(s)); } catch (...) {}
-    }
-    try { return Value(std::stoi(s)); } catch (...) {}
+    if (Int i; parseInteger(s, i)) return Value(i);
+    if (Real r; parseReal(s, r)) return Value(r);
     if (s == "true") return Value(true);
     if (s == "false") return Value(false);
     if (s == "null") return Value(Null{});
-    throw std::runtime_error("Hằng số không hợp lệ: '" + s + "'");
+    throw std::runtime_error("Hằng số không hợp lệ: '" + Str(s) + "'");
 }
 
 void BytecodeParser::resolveAllLabels() {
-    for (auto& pair : protos) {
-        auto proto = pair.second;
+    for (auto& [name, function] : module->functions) {
+        auto proto = &function;
         for (const auto& jump : proto->pendingJumps) {
             Int instIdx = std::get<0>(jump);
             Int argIdx = std::get<1>(jump);
             Str labelName = std::get<2>(jump);
             auto it = proto->labels.find(labelName);
             if (it == proto->labels.end()) {
-                throw std::runtime_error("Không tìm thấy nhãn '" + labelName + "' trong hàm '" + proto->sourceName + "'");
+                throw std::runtime_error("Không tìm thấy nhãn '" + labelName + "' trong hàm '" + name + "'");
             }
             proto->code[instIdx].args[argIdx] = it->second;
         }
@@ -282,22 +429,40 @@ void BytecodeParser::resolveAllLabels() {
     }
 }
 
-void BytecodeParser::linkProtos() {
+void BytecodeParser::collectImports(ParsedModule& module) {
+    for (const auto& [name, function] : module.functions) {
+        for (const auto& inst : function.code) {
+            if (inst.op != OpCode::IMPORT_MODULE || inst.args.size() < 2) continue;
+            Int pathIdx = inst.args[1];
+            if (pathIdx < 0 || pathIdx >= static_cast<Int>(function.constantPool.size())) continue;
+            if (function.constantPool[pathIdx].is_string()) module.imports.push_back(function.constantPool[pathIdx].get<Str>());
+        }
+    }
+}
+
+void BytecodeParser::resolveProtoConstants(ObjFunctionProto& proto, const std::unordered_map<Str, Proto>& protos) {
     const Str& prefix = "::function_proto::";
-    for (auto& pair : protos) {
-        auto proto = pair.second;
-        for (size_t i = 0; i < proto->constantPool.size(); ++i) {
-            if (proto->constantPool[i].is_string()) {
-                auto s = proto->constantPool[i].get<Str>();
-                if (s.rfind(prefix, 0) == 0) {
-                    Str protoName = s.substr(prefix.length());
-                    auto it = protos.find(protoName);
-                    
-                    if (it != protos.end()) {
-                        proto->constantPool[i] = Value(it->second);
-                    }
+    for (size_t i = 0; i < proto.constantPool.size(); ++i) {
+        if (proto.constantPool[i].is_string()) {
+            auto s = proto.constantPool[i].get<Str>();
+            if (s.rfind(prefix, 0) == 0) {
+                Str protoName = s.substr(prefix.length());
+                auto it = protos.find(protoName);
+                
+                if (it != protos.end()) {
+                    proto.constantPool[i] = Value(it->second);
                 }
             }
         }
     }
+}
+
+void BytecodeParser::linkProtos() {
+    // Call windows look at the protos CLOSURE refers to, so every constant is resolved first
+    for (auto& pair : protos) {
+        resolveProtoConstants(*pair.second, protos);
+    }
+    for (auto& pair : protos) {
+        pair.second->attachInlineCaches();
+    }
 }
\ No newline at end of file
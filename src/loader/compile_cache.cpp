@@ -0,0 +1,175 @@
+#include "compile_cache.h"
+#include "binary_format.h"
+#include "mapped_file.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    inline constexpr char CACHE_MAGIC[8] = { 'M', 'E', 'O', 'W', 'C', 'C', 'H', '\0' };
+
+    // Precedes the `.meowb` image in every entry. 56 bytes, so the image keeps its 8-byte alignment
+    struct CacheEntryHeader {
+        char magic[8];
+        Uint32 parserVersion;
+        Uint32 binaryVersion;
+        Uint64 sourceSize;
+        Uint8 digest[32];      // SHA-256 of the source text
+    };
+    static_assert(sizeof(CacheEntryHeader) == 56);
+
+    // SHA-256 (FIPS 180-4). Unlike std::hash it is the same in every build, and a collision is not a concern
+    std::array<Uint8, 32> sha256(std::string_view data) {
+        static constexpr Uint32 K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+        Uint32 h[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+        auto compress = [&](const Uint8* block) {
+            Uint32 w[64];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = Uint32{block[i * 4]} << 24 | Uint32{block[i * 4 + 1]} << 16 | Uint32{block[i * 4 + 2]} << 8 | block[i * 4 + 3];
+            }
+            for (int i = 16; i < 64; ++i) {
+                Uint32 s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                Uint32 s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            Uint32 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+            for (int i = 0; i < 64; ++i) {
+                Uint32 t1 = k + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                Uint32 t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                k = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+        };
+
+        const Uint8* bytes = reinterpret_cast<const Uint8*>(data.data());
+        size_t full = data.size() / 64 * 64;
+        for (size_t i = 0; i < full; i += 64) compress(bytes + i);
+
+        // The tail, a 0x80 byte, zero padding and the bit length fill one or two final blocks
+        Uint8 tail[128] = {};
+        size_t rest = data.size() - full;
+        if (rest) std::memcpy(tail, bytes + full, rest);
+        tail[rest] = 0x80;
+        size_t tailSize = rest < 56 ? 64 : 128;
+        Uint64 bits = static_cast<Uint64>(data.size()) * 8;
+        for (int i = 0; i < 8; ++i) tail[tailSize - 1 - i] = static_cast<Uint8>(bits >> (i * 8));
+        for (size_t i = 0; i < tailSize; i += 64) compress(tail + i);
+
+        std::array<Uint8, 32> digest;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) digest[i * 4 + j] = static_cast<Uint8>(h[i] >> (24 - j * 8));
+        }
+        return digest;
+    }
+
+    Uint64 processId() {
+#if defined(_WIN32)
+        return static_cast<Uint64>(_getpid());
+#else
+        return static_cast<Uint64>(getpid());
+#endif
+    }
+}
+
+CompileCache::CompileCache() {
+    auto env = [](const char* name) -> Str {
+        const char* value = std::getenv(name);
+        return value ? Str(value) : Str();
+    };
+    if (!env("MEOW_NO_CACHE").empty()) {
+        enabled_ = false;
+        return;
+    }
+    if (Str dir = env("MEOW_CACHE_DIR"); !dir.empty()) {
+        directory = dir;
+    } else if (Str xdg = env("XDG_CACHE_HOME"); !xdg.empty()) {
+        directory = std::filesystem::path(xdg) / "meow-vm";
+    } else if (Str home = env("HOME"); !home.empty()) {
+        directory = std::filesystem::path(home) / ".cache" / "meow-vm";
+    } else if (Str local = env("LOCALAPPDATA"); !local.empty()) {
+        directory = std::filesystem::path(local) / "meow-vm";
+    }
+}
+
+std::filesystem::path CompileCache::entryFor(const Digest& digest) const {
+    std::ostringstream name;
+    name << std::hex << std::setfill('0');
+    for (size_t i = 0; i < 16; ++i) name << std::setw(2) << static_cast<unsigned>(digest[i]);
+    name << std::dec << "-v" << BINARY_VERSION << "-p" << BytecodeParser::VERSION << "-O" << OPTIMIZATION_LEVEL << ".meowb";
+    return directory / name.str();
+}
+
+ParsedModule CompileCache::readFile(const Str& path, BytecodeParser& parser) const {
+    MappedFile source;
+    if (!enabled() || !source.open(path)) return parser.readFile(path);
+
+    Digest digest = sha256(source.view());
+    std::filesystem::path entry = entryFor(digest);
+    MappedFile cached;
+    if (cached.open(entry.string()) && cached.view().size() >= sizeof(CacheEntryHeader)) {
+        CacheEntryHeader header;
+        std::memcpy(&header, cached.view().data(), sizeof(header));
+        if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+            header.parserVersion == BytecodeParser::VERSION && header.binaryVersion == BINARY_VERSION &&
+            header.sourceSize == source.view().size() && std::memcmp(header.digest, digest.data(), digest.size()) == 0) {
+            ParsedModule parsed;
+            Str error;
+            if (readBinaryModule(cached.view().substr(sizeof(header)), parsed, error)) return parsed;
+        }
+    }
+
+    ParsedModule parsed = parser.read(source.view(), path);
+    if (parsed.error.empty()) store(entry, digest, source.view().size(), parsed);
+    return parsed;
+}
+
+void CompileCache::store(const std::filesystem::path& entry, const Digest& digest, Uint64 sourceSize, const ParsedModule& module) const {
+    std::vector<char> image;
+    Str error;
+    if (!writeBinaryModule(module, image, error)) return;
+
+    CacheEntryHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.parserVersion = BytecodeParser::VERSION;
+    header.binaryVersion = BINARY_VERSION;
+    header.sourceSize = sourceSize;
+    std::memcpy(header.digest, digest.data(), digest.size());
+
+    // A cache that cannot be written is just a cache miss next time
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) return;
+    std::ostringstream suffix;
+    suffix << ".tmp-" << processId() << '-' << std::this_thread::get_id() << '-'
+           << std::chrono::steady_clock::now().time_since_epoch().count();
+    std::filesystem::path temp = entry;
+    temp += suffix.str();
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+            out.close();
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temp, entry, ec);
+    if (ec) std::filesystem::remove(temp, ec);
+}
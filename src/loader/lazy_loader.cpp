@@ -0,0 +1,119 @@
+#include "lazy_loader.h"
+#include "binary_parser.h"
+#include "bytecode_parser.h"
+#include "mapped_file.h"
+#include "memory_manager.h"
+
+namespace {
+    /// @brief Function bodies of a `.meowb` image, decoded straight from the mapping
+    class LazyBinaryBodies : public LazyBodySource {
+    public:
+        LazyBinaryBodies(MappedFile&& file, std::vector<Proto> byIndex) : file(std::move(file)), byIndex(std::move(byIndex)) {
+            Str error;
+            image.open(this->file.view(), error);
+        }
+
+        Bool load(ObjFunctionProto& proto, Str& error) override {
+            return BinaryParser::loadBody(image, proto.lazyIndex, byIndex, proto, error);
+        }
+
+        void trace(GCVisitor& visitor) const noexcept override {
+            for (Proto proto : byIndex) visitor.visit_object(proto);
+        }
+    private:
+        MappedFile file;
+        BinaryModuleView image;
+        std::vector<Proto> byIndex;
+    };
+
+    /// @brief Function bodies of a text module, each parsed from its own `.func` block
+    class LazyTextBodies : public LazyBodySource {
+    public:
+        LazyTextBodies(MappedFile&& file, Str sourceName, std::vector<FunctionExtent> extents, std::unordered_map<Str, Proto> protos)
+            : file(std::move(file)), sourceName(std::move(sourceName)), extents(std::move(extents)), protos(std::move(protos)) {}
+
+        Bool load(ObjFunctionProto& proto, Str& error) override {
+            const FunctionExtent& extent = extents[proto.lazyIndex];
+            BytecodeParser parser;
+            ParsedModule parsed = parser.read(file.view().substr(extent.begin, extent.end - extent.begin), sourceName, extent.firstLine);
+            if (!parsed.error.empty()) {
+                error = parsed.error;
+                return false;
+            }
+            BytecodeParser::fillProto(std::move(parsed.functions.at(extent.name)), proto);
+            BytecodeParser::resolveProtoConstants(proto, protos);
+            return true;
+        }
+
+        void trace(GCVisitor& visitor) const noexcept override {
+            for (const auto& [name, proto] : protos) visitor.visit_object(proto);
+        }
+    private:
+        MappedFile file;
+        Str sourceName;
+        std::vector<FunctionExtent> extents;
+        std::unordered_map<Str, Proto> protos;
+    };
+}
+
+Bool LazyModuleLoader::parseTextFile(const Str& filepath, MemoryManager& mm) {
+    protos.clear();
+    MappedFile file;
+    if (!file.open(filepath)) {
+        std::cerr << "Error: Cannot open file: " << filepath << std::endl;
+        return false;
+    }
+    BytecodeParser parser;
+    ScannedModule scanned = parser.scan(file.view(), filepath);
+    if (!scanned.error.empty()) {
+        std::cerr << scanned.error << std::endl;
+        return false;
+    }
+
+    // A later `.func` of the same name replaces the earlier one, as when parsing eagerly
+    std::unordered_map<Str, size_t> latest;
+    for (size_t i = 0; i < scanned.functions.size(); ++i) latest[scanned.functions[i].name] = i;
+    std::vector<FunctionExtent> extents;
+    extents.reserve(latest.size());
+    for (size_t i = 0; i < scanned.functions.size(); ++i) {
+        if (latest[scanned.functions[i].name] == i) extents.push_back(std::move(scanned.functions[i]));
+    }
+
+    // Each proto is rooted through `protos` as soon as it exists
+    for (const FunctionExtent& extent : extents) {
+        protos[extent.name] = mm.newObject<ObjFunctionProto>(extent.numRegisters, extent.numUpvalues, extent.name);
+    }
+    auto bodies = mm.newObject<LazyTextBodies>(std::move(file), filepath, extents, protos);
+    for (Uint32 i = 0; i < extents.size(); ++i) {
+        Proto proto = protos[extents[i].name];
+        proto->lazyBody = bodies;
+        proto->lazyIndex = i;
+    }
+    return true;
+}
+
+Bool LazyModuleLoader::parseBinaryFile(const Str& filepath, MemoryManager& mm) {
+    protos.clear();
+    auto fail = [&](const Str& what) {
+        std::cerr << "Error in '" << filepath << "': " << what << std::endl;
+        protos.clear();
+        return false;
+    };
+    MappedFile file;
+    if (!file.open(filepath)) {
+        std::cerr << "Error: Cannot open file: " << filepath << std::endl;
+        return false;
+    }
+    BinaryModuleView image;
+    Str error;
+    if (!image.open(file.view(), error)) return fail(error);
+
+    std::vector<Proto> byIndex;
+    if (!BinaryParser::allocateProtos(image, mm, protos, byIndex, error)) return fail(error);
+    auto bodies = mm.newObject<LazyBinaryBodies>(std::move(file), byIndex);
+    for (Uint32 i = 0; i < byIndex.size(); ++i) {
+        byIndex[i]->lazyBody = bodies;
+        byIndex[i]->lazyIndex = i;
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#include "mapped_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        buffer_ = std::move(other.buffer_);
+        data_ = other.mapped_ ? other.data_ : buffer_.data();
+        size_ = other.size_;
+        mapped_ = other.mapped_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+Bool MappedFile::open(const Str& path) {
+    close();
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            data_ = buffer_.data();
+            return true;
+        }
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::close(fd);
+            data_ = static_cast<const char*>(p);
+            mapped_ = true;
+            return true;
+        }
+    }
+    ::close(fd);
+    size_ = 0;
+#endif
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+}
+
+void MappedFile::close() noexcept {
+#if !defined(_WIN32)
+    if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+    buffer_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+}
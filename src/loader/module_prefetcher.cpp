@@ -0,0 +1,79 @@
+#include "module_prefetcher.h"
+#include "native_module_registry.h"
+
+ModulePrefetcher::~ModulePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queued.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ModulePrefetcher::prefetchImports(const std::vector<Str>& imports, const Str& importer) {
+    std::vector<Str> paths;
+    for (const auto& spec : imports) {
+        try {
+            // Native libraries are loaded by the VM itself
+            if (NativeModuleRegistry::find(spec) || !resolver.resolveLibrary(spec, importer).empty()) continue;
+            paths.push_back(resolver.resolveSource(spec, importer));
+        } catch (const std::exception&) {
+            // Left for the VM to report when execution reaches the import
+        }
+    }
+    if (paths.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) return;
+    for (auto& path : paths) {
+        if (!tasks.try_emplace(path, std::make_unique<Task>()).second) continue;
+        pending.push_back(std::move(path));
+        queued.notify_one();
+    }
+    // Workers start with the first import, so programs without any never spawn a thread
+    if (workers.empty() && !pending.empty()) {
+        size_t count = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 9) - 1;
+        for (size_t i = 0; i < count; ++i) workers.emplace_back(&ModulePrefetcher::work, this);
+    }
+}
+
+std::optional<ParsedModule> ModulePrefetcher::take(const Str& path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = tasks.find(path);
+    if (it == tasks.end() || it->second->taken) return std::nullopt;
+    Task& task = *it->second;
+    finished.wait(lock, [&] { return task.done; });
+    task.taken = true;
+    return std::move(task.parsed);
+}
+
+void ModulePrefetcher::work() {
+    BytecodeParser parser;
+    for (;;) {
+        Str path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [&] { return stopping || !pending.empty(); });
+            if (stopping) return;
+            path = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        ParsedModule parsed;
+        try {
+            parsed = cache.readFile(path, parser);
+            prefetchImports(parsed.imports, path);
+        } catch (const std::exception& e) {
+            parsed = ParsedModule{};
+            parsed.error = "Error: Cannot parse file: " + path + " (" + e.what() + ")";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Task& task = *tasks.at(path);
+            task.parsed = std::move(parsed);
+            task.done = true;
+        }
+        finished.notify_all();
+    }
+}
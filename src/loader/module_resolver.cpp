@@ -0,0 +1,227 @@
+#include "module_resolver.h"
+
+#include <chrono>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#include <limits.h>
+#endif
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+// --- helper: lấy thư mục chứa executable (cross-platform) ---
+static std::filesystem::path getExecutableDir() {
+#if defined(_WIN32)
+    char buf[MAX_PATH];
+    DWORD len = GetModuleFileNameA(NULL, buf, MAX_PATH);
+    if (len == 0) throw std::runtime_error("GetModuleFileNameA failed");
+    return std::filesystem::path(std::string(buf, static_cast<size_t>(len))).parent_path();
+#elif defined(__linux__)
+    char buf[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (len == -1) throw std::runtime_error("readlink(/proc/self/exe) failed");
+    buf[len] = '\0';
+    return std::filesystem::path(std::string(buf)).parent_path();
+#elif defined(__APPLE__)
+    uint32_t size = 0;
+    _NSGetExecutablePath(nullptr, &size); // will set size
+    std::vector<char> buf(size);
+    if (_NSGetExecutablePath(buf.data(), &size) != 0) {
+        throw std::runtime_error("_NSGetExecutablePath failed");
+    }
+    std::filesystem::path p(buf.data());
+    return std::filesystem::absolute(p).parent_path();
+#else
+    return std::filesystem::current_path();
+#endif
+}
+
+// --- helper: expand token $ORIGIN in a path string to exeDir ---
+static std::string expandOriginToken(const std::string& raw, const std::filesystem::path& exeDir) {
+    std::string out;
+    const std::string token = "$ORIGIN";
+    size_t pos = 0;
+    while (true) {
+        size_t p = raw.find(token, pos);
+        if (p == std::string::npos) {
+            out.append(raw.substr(pos));
+            break;
+        }
+        out.append(raw.substr(pos, p - pos));
+        out.append(exeDir.string());
+        pos = p + token.size();
+    }
+    return out;
+}
+
+// --- detect stdlib root: đọc file meow-root cạnh binary (1 lần, cached) ---
+static std::filesystem::path detectStdlibRoot_cached() {
+    static std::optional<std::filesystem::path> cached;
+    if (cached.has_value()) return *cached;
+
+    std::filesystem::path result;
+    try {
+        std::filesystem::path exeDir = getExecutableDir(); // thư mục chứa binary
+        std::filesystem::path configFile = exeDir / "meow-root";
+
+        // 1) nếu có file meow-root, đọc và expand $ORIGIN
+        if (std::filesystem::exists(configFile)) {
+            std::ifstream in(configFile);
+            if (in) {
+                std::string line;
+                std::getline(in, line);
+                // trim (simple)
+                while (!line.empty() && (line.back() == '\n' || line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+                size_t i = 0;
+                while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+                if (i > 0) line = line.substr(i);
+
+                if (!line.empty()) {
+                    std::string expanded = expandOriginToken(line, exeDir);
+                    result = std::filesystem::absolute(std::filesystem::path(expanded));
+                    cached = result;
+                    return result;
+                }
+            }
+        }
+
+        // 2) fallback nhanh: nếu exeDir là "bin", dùng parent; ngược lại dùng exeDir
+        if (exeDir.filename() == "bin") {
+            result = exeDir.parent_path();
+        } else {
+            result = exeDir;
+        }
+
+        // 3) nếu không tìm thấy stdlib trực tiếp ở root, có thể thử root/lib
+        cached = std::filesystem::absolute(result);
+        return *cached;
+    } catch (...) {
+        // fallback to current path nếu có gì sai
+        cached = std::filesystem::current_path();
+        return *cached;
+    }
+}
+
+#if defined(_WIN32)
+static const char* const LIBRARY_EXTENSION = ".dll";
+#elif defined(__APPLE__)
+static const char* const LIBRARY_EXTENSION = ".dylib";
+#else
+static const char* const LIBRARY_EXTENSION = ".so";
+#endif
+
+std::filesystem::path ModuleResolver::importerDir(const Str& importer) const {
+    return (importer == entryPointDir)
+        ? std::filesystem::path(entryPointDir)
+        : std::filesystem::path(importer).parent_path();
+}
+
+Bool ModuleResolver::isFile(const std::filesystem::path& path) {
+#if defined(_WIN32) || defined(__APPLE__)
+    // Names there usually match case-insensitively, by folding rules a listing cannot reproduce, so ask the filesystem
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec);
+#else
+    Str dir = path.parent_path().lexically_normal().string();
+    auto it = directories.find(dir);
+    if (it == directories.end()) {
+        // One directory read stands in for every later probe into this directory
+        std::unordered_set<Str> names;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator entry(dir.empty() ? "." : dir, ec), end; !ec && entry != end; entry.increment(ec)) {
+            // Follows symlinks, so a link to a module counts and a directory named like one does not
+            std::error_code typeError;
+            if (entry->is_regular_file(typeError)) names.insert(entry->path().filename().string());
+        }
+        it = directories.emplace(std::move(dir), std::move(names)).first;
+    }
+    return it->second.count(path.filename().string()) != 0;
+#endif
+}
+
+const std::vector<std::filesystem::path>& ModuleResolver::stdlibSearchRoots() {
+    if (!searchRootsReady) {
+        std::filesystem::path stdlibRoot = detectStdlibRoot_cached();
+        // Thứ tự tìm: root, root/lib, root/stdlib, root/bin/stdlib, root/bin, rồi ../bin/stdlib
+        // (nếu meow-root thực sự trỏ lên một level)
+        for (const auto& root : {
+                 stdlibRoot,
+                 stdlibRoot / "lib",
+                 stdlibRoot / "stdlib",
+                 stdlibRoot / "bin" / "stdlib",
+                 stdlibRoot / "bin",
+                 stdlibRoot / ".." / "bin" / "stdlib" }) {
+            std::error_code ec;
+            std::filesystem::path dir = std::filesystem::absolute(root, ec).lexically_normal();
+            if (!ec && std::filesystem::is_directory(dir, ec)) searchRoots.push_back(std::move(dir));
+        }
+        searchRootsReady = true;
+    }
+    return searchRoots;
+}
+
+Str ModuleResolver::findLibrary(const Str& spec, const std::filesystem::path& baseDir) {
+    std::filesystem::path candidate(spec);
+    Str ext = candidate.extension().string();
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == ".meow" || ext == ".meowb") return "";
+    if (ext.empty()) candidate.replace_extension(LIBRARY_EXTENSION);
+
+    std::error_code ec;
+    if (candidate.is_absolute()) {
+        if (isFile(candidate)) return candidate.lexically_normal().string();
+    }
+    for (const auto& root : stdlibSearchRoots()) {
+        std::filesystem::path path = (root / candidate).lexically_normal();
+        if (isFile(path)) return path.string();
+    }
+    std::filesystem::path relativePath = std::filesystem::absolute(baseDir / candidate, ec).lexically_normal();
+    if (!ec && isFile(relativePath)) return relativePath.string();
+    return "";
+}
+
+template <typename Resolve>
+Str ModuleResolver::lookup(char kind, const Str& spec, const Str& importer, Resolve&& resolve) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto start = std::chrono::steady_clock::now();
+    std::filesystem::path baseDir = importerDir(importer);
+    Str key;
+    key.reserve(spec.size() + importer.size() + 3);
+    key.append(1, kind).append(1, '\0').append(baseDir.string()).append(1, '\0').append(spec);
+
+    auto it = resolved.find(key);
+    Bool hit = it != resolved.end();
+    if (!hit) it = resolved.emplace(std::move(key), resolve(baseDir)).first;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    ++stats.lookups;
+    stats.cached += hit;
+    stats.nanoseconds += static_cast<Uint64>(elapsed);
+    if (tracing) {
+        std::ostringstream cost;
+        cost << std::fixed << std::setprecision(1) << elapsed / 1000.0 << "us";
+        std::cerr << "[import] " << (kind == 'L' ? "library " : "source  ") << "'" << spec << "' from '" << baseDir.string() << "' -> "
+                  << (it->second.empty() ? "<none>" : it->second) << (hit ? " (cached, " : " (") << cost.str() << ")" << std::endl;
+    }
+    return it->second;
+}
+
+Str ModuleResolver::resolveLibrary(const Str& spec, const Str& importer) {
+    return lookup('L', spec, importer, [&](const std::filesystem::path& baseDir) {
+        try {
+            return findLibrary(spec, baseDir);
+        } catch (const std::exception&) {
+            return Str();
+        }
+    });
+}
+
+Str ModuleResolver::resolveSource(const Str& spec, const Str& importer) {
+    return lookup('S', spec, importer, [&](const std::filesystem::path& baseDir) {
+        return std::filesystem::absolute(baseDir / spec).lexically_normal().string();
+    });
+}
@@ -1,32 +1,87 @@
 #include "meow_vm.h"
 
+#include <charconv>
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " [--binary] <entry_file>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [--binary] [--ic-stats] [--trace-imports] [--no-cache] [--lazy] [--stack-slots=n] [--snapshot-create=file] <entry_file>" << std::endl;
+        std::cerr << "       " << argv[0] << " [--ic-stats] [--stack-slots=n] --snapshot-load=file" << std::endl;
         return 1;
     }
 
     std::string entryPath;
     bool isBinary = false;
+    bool icStats = false;
+    bool traceImports = false;
+    bool noCache = false;
+    bool lazy = false;
+    std::string snapshotCreate;
+    std::string snapshotLoad;
+    long long stackSlots = 0;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--binary") {
             isBinary = true;
+        } else if (arg == "--ic-stats") {
+            icStats = true;
+        } else if (arg == "--trace-imports") {
+            traceImports = true;
+        } else if (arg == "--no-cache") {
+            noCache = true;
+        } else if (arg == "--lazy") {
+            lazy = true;
+        } else if (arg.rfind("--stack-slots=", 0) == 0) {
+            std::string value = arg.substr(sizeof("--stack-slots=") - 1);
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), stackSlots);
+            if (ec != std::errc() || ptr != value.data() + value.size() || stackSlots <= 0) {
+                std::cerr << "Lỗi: --stack-slots cần một số nguyên dương." << std::endl;
+                return 1;
+            }
+            if (stackSlots > MeowVM::MAX_STACK_SLOTS) {
+                std::cerr << "Lỗi: --stack-slots không được vượt quá " << MeowVM::MAX_STACK_SLOTS << "." << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--snapshot-create=", 0) == 0) {
+            snapshotCreate = arg.substr(sizeof("--snapshot-create=") - 1);
+        } else if (arg.rfind("--snapshot-load=", 0) == 0) {
+            snapshotLoad = arg.substr(sizeof("--snapshot-load=") - 1);
         } else if (entryPath.empty()) {
             entryPath = arg;
         }
     }
 
-    if (entryPath.empty()) {
+    if (entryPath.empty() && snapshotLoad.empty()) {
         std::cerr << "Lỗi: Bạn phải cung cấp tên file đầu vào." << std::endl;
         return 1;
     }
 
     MeowVM vm(".", argc, argv);
-    
+    vm.setTraceImports(traceImports);
+    if (noCache) vm.setCompileCacheEnabled(false);
+    vm.setLazyLoading(lazy);
+    if (stackSlots > 0) vm.setStackLimit(stackSlots);
 
-    vm.interpret(entryPath, isBinary);
+    if (!snapshotLoad.empty()) {
+        vm.resume(snapshotLoad);
+    } else {
+        vm.setSnapshotOutput(snapshotCreate);
+        vm.interpret(entryPath, isBinary);
+        if (!snapshotCreate.empty() && !vm.hasWrittenSnapshot()) {
+            std::cerr << "Lỗi: chương trình kết thúc mà không gọi snapshot_point(), không có snapshot nào được ghi." << std::endl;
+            return 1;
+        }
+    }
+
+    if (icStats) {
+        auto stats = vm.getInlineCacheStats();
+        std::cerr << "[ic] hits: " << stats.hits << ", misses: " << stats.misses << std::endl;
+    }
+    if (traceImports) {
+        auto stats = vm.getImportTraceStats();
+        std::cerr << "[import] lookups: " << stats.lookups << ", cached: " << stats.cached
+                  << ", resolving: " << stats.nanoseconds / 1000 << "us" << std::endl;
+    }
     
     return 0;
 }
\ No newline at end of file
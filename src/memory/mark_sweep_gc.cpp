@@ -16,6 +16,11 @@ void MarkSweepGC::collect(MeowVM& vm_instance) noexcept {
     this->vm = &vm_instance;
 
     vm->traceRoots(*this);
+    while (!grayStack.empty()) {
+        const MeowObject* obj = grayStack.back();
+        grayStack.pop_back();
+        obj->trace(*this);
+    }
 
     for (auto it = metadata.begin(); it != metadata.end();) {
         const MeowObject* obj = it->first;
@@ -53,6 +58,13 @@ void MarkSweepGC::visit_value(const Value& value) noexcept {
         mark(value.get<Array>());
     } else if (value.is_hash()) {
         mark(value.get<Object>());
+    } else if (value.is_typed_array()) {
+        mark(value.get<TypedArray>());
+    } else if (value.is_rope()) {
+        mark(value.get<Rope>());
+    } else if (auto native = value.get_if<NativeFn>()) {
+        // A native bound to a receiver keeps the receiver alive
+        if (auto bound = std::get_if<BoundNative>(native)) visit_value((*bound)->receiver);
     }
 }
 
@@ -68,7 +80,7 @@ void MarkSweepGC::mark(const MeowObject* object) noexcept {
 
     it->second.isMarked = true;
 
-    object->trace(*this);
+    grayStack.push_back(object);
 }
 
 
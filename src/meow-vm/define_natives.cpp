@@ -11,13 +11,15 @@ overloaded(Ts...) -> overloaded<Ts...>;
 
 void MeowVM::defineNativeFunctions() {
     auto nativePrint = [this](Arguments args) -> Value {
-        Str outputString;
         for (size_t i = 0; i < args.size(); ++i) {
-            if (i > 0) outputString += " ";
-            outputString += _toString(args[i]);
+            if (i > 0) std::cout << ' ';
+            // Strings are written as they are and ropes piece by piece, instead of being copied or joined first
+            if (auto text = args[i].get_if<Str>()) std::cout << *text;
+            else if (args[i].is_rope()) args[i].get<Rope>()->writeTo(std::cout);
+            else std::cout << _toString(args[i]);
         }
 
-        std::cout << outputString << std::endl;
+        std::cout << std::endl;
         return Value(Null{});
     };
 
@@ -50,6 +52,12 @@ void MeowVM::defineNativeFunctions() {
     //     }, args[0]));
     // };
 
+    // Marks where --snapshot-create stops the program; the snapshot is written once the call returns
+    auto snapshotPoint = [this](Arguments) {
+        if (!snapshotPath.empty()) snapshotPending = true;
+        return Value(Null{});
+    };
+
     auto toInt = [this](Arguments args) {
         return Value(this->_toInt(args[0]));
     };
@@ -156,14 +164,18 @@ void MeowVM::defineNativeFunctions() {
     natives["real"] = Value(toReal);
     natives["bool"] = Value(toBool);
     natives["str"]  = Value(toStr);
+    natives["snapshot_point"] = Value(snapshotPoint);
+    defineTypedArrayNatives(natives);
+    defineStringNatives();
     // natives["ord"]    = Value(nativeOrd);
     // natives["char"]   = Value(nativeChar);
     // natives["range"]  = Value(nativeRange);
 
 
     auto nativeModule = memoryManager->newObject<ObjModule>("native", "native");
-    nativeModule->globals = natives;
+    for (const auto& [name, value] : natives) nativeModule->setGlobal(name, value);
     moduleCache["native"] = nativeModule;
+    builtinScope = nativeModule;
 
     // std::vector<Str> list = {"array", "object", "string"};
 
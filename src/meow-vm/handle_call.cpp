@@ -33,74 +33,114 @@ void MeowVM::closeUpvalues(Int slotIndex) {
     }
 }
 
-void MeowVM::_executeCall(const Value& callee, Int dst, Int argStart, Int argc, Int base) {
+Int MeowVM::_openCallWindow(Int numRegisters, Int base, Int argStart, Int argc, Int freeFrom, Int leading) {
+    // The callee's registers start right on its arguments when the caller never reads anything from
+    // there up again (see ObjFunctionProto::planCallWindows) and no open upvalue points into that range
+    Int first = argStart - leading;
+    Int top = static_cast<Int>(stackSlots.size());
+    if (freeFrom >= 0 && first >= freeFrom && base + argStart + argc <= top &&
+        (openUpvalues.empty() || openUpvalues.back()->slotIndex < base + first)) {
+        Int start = base + first;
+        Int end = start + numRegisters;
+        _growStack(end);
+        // Parameters nobody passed, and whatever the caller left above the arguments, start out null
+        for (Int slot = start + leading + argc; slot < std::min(end, top); ++slot) {
+            stackSlots[slot] = Value(Null{});
+        }
+        return start;
+    }
+
+    Int start = top;
+    _growStack(start + numRegisters);
+    Int copied = std::clamp<Int>(numRegisters - leading, 0, argc);
+    for (Int i = 0; i < copied; ++i) {
+        stackSlots[start + leading + i] = stackSlots[base + argStart + i];
+    }
+    return start;
+}
 
-    std::vector<Value> args;
-    args.reserve(argc);
-    for (Int i = 0; i < argc; ++i) {
-        args.push_back(stackSlots[base + argStart + i]);
+void MeowVM::_growStack(Int size) {
+    if (size > stackLimit) {
+        throwVMError("Tràn ngăn xếp: cần " + std::to_string(size) + " thanh ghi, tối đa " + std::to_string(stackLimit));
     }
+    if (size > static_cast<Int>(stackSlots.size())) stackSlots.resize(static_cast<size_t>(size), Value(Null{}));
+}
+
+void MeowVM::_setStackTop(Int size) {
+    if (size > static_cast<Int>(stackSlots.size())) _growStack(size);
+    else stackSlots.resize(static_cast<size_t>(size));
+}
+
+void MeowVM::_finishNativeCall(const NativeFn& native, const Value* receiver, Int dst, Int argStart, Int argc, Int base) {
+    // The native reads its arguments straight from the caller's registers; stackSlots never
+    // moves, so the view survives the native calling back into the VM
+    Arguments args(stackSlots.data() + base + argStart, static_cast<size_t>(argc));
+    Value result = _callNative(native, receiver, args);
+    if (dst != -1) stackSlots[base + dst] = result;
+    if (snapshotPending) _writeSnapshot();
+}
 
+Value MeowVM::_callNative(const NativeFn& native, const Value* receiver, Arguments args) {
+    return std::visit(
+        [&](const auto& fn) -> Value {
+            using T = std::decay_t<decltype(fn)>;
+            if constexpr (std::is_same_v<T, BoundNative>) {
+                return _callNative(fn->function, &fn->receiver, args);
+            } else if constexpr (std::is_same_v<T, NativeFnMethod>) {
+                if (!receiver) throwVMError("Native method called without a receiver");
+                return fn(this, *receiver, args);
+            } else if (!receiver) {
+                if constexpr (std::is_same_v<T, NativeFnSimple>) return fn(args);
+                else return fn(this, args);
+            } else {
+                // Natives with the older signatures take the receiver as their first argument
+                std::vector<Value> withReceiver;
+                withReceiver.reserve(args.size() + 1);
+                withReceiver.push_back(*receiver);
+                withReceiver.insert(withReceiver.end(), args.begin(), args.end());
+                if constexpr (std::is_same_v<T, NativeFnSimple>) return fn(withReceiver);
+                else return fn(this, withReceiver);
+            }
+        },
+        native
+    );
+}
+
+void MeowVM::_executeCall(const Value& callee, Int dst, Int argStart, Int argc, Int base, Int freeFrom) {
+    // `callee` may live in stackSlots, so everything needed from it is read before the stack grows
     if (callee.is_function()) {
         auto closure = callee.get<Function>();
-        Int newStart = static_cast<Int>(stackSlots.size());
-        Int needed = newStart + closure->proto->numRegisters;
-        stackSlots.resize(needed, Value(Null{}));
-
-        if (static_cast<Int>(stackSlots.size()) < needed) {
-            throwVMError("stackSlots quá nhỏ khi resize trong _executeCall. "
-                        "cần=" + std::to_string(needed) +
-                        " đã có=" + std::to_string(stackSlots.size()));
-        }
-
+        Int newStart = _openCallWindow(closure->proto->numRegisters, base, argStart, argc, freeFrom, 0);
         CallFrame newFrame(closure, newStart, callStack.back().module, 0, dst);
         callStack.push_back(newFrame);
-
-        for (Int i = 0; i < std::min(argc, static_cast<Int>(closure->proto->numRegisters)); ++i) {
-            stackSlots[newStart + i] = args[i];
-        }
     } else if (callee.is_bound_method()) {
         auto boundMethod = callee.get<BoundMethod>();
         if (!Value(boundMethod->callable).is_function()) throwVMError("Bound method không chứa một closure có thể gọi được.");
         auto methodClosure = boundMethod->callable;
-        Int newStart = static_cast<Int>(stackSlots.size());
-        stackSlots.resize(newStart + methodClosure->proto->numRegisters);
+        Value receiver(boundMethod->receiver);
+        Int newStart = _openCallWindow(methodClosure->proto->numRegisters, base, argStart, argc, freeFrom, 1);
         CallFrame newFrame(methodClosure, newStart, callStack.back().module, 0, dst);
         callStack.push_back(newFrame);
-        stackSlots[newStart + 0] = Value(boundMethod->receiver);
-        for (Int i = 0; i < std::min(argc, static_cast<Int>(methodClosure->proto->numRegisters - 1)); ++i) {
-            stackSlots[newStart + 1 + i] = args[i];
-        }
+        if (methodClosure->proto->numRegisters > 0) stackSlots[newStart] = receiver;
     } else if (callee.is_class()) {
         auto klass = callee.get<Class>();
-        auto instance = memoryManager->newObject<ObjInstance>(klass);
+        HandleScope scope(this);
+        auto instance = scope.root(memoryManager->newObject<ObjInstance>(klass));
         if (dst != -1) stackSlots[base + dst] = Value(instance);
-        auto it = klass->methods.find("init");
-        if (it != klass->methods.end() && (it->second).is_function()) {
-            auto boundInit = memoryManager->newObject<ObjBoundMethod>(instance, it->second.get<Function>());
+        auto init = findClassMethod(klass, "init");
+        if (init && init->is_function()) {
+            // `dst` already holds the instance, so init never reuses the caller's registers
+            auto boundInit = memoryManager->newObject<ObjBoundMethod>(instance, init->get<Function>());
             _executeCall(Value(boundInit), -1, argStart, argc, base);
         }
     } else if (callee.is_native_fn()) {
-        auto func = callee.get<NativeFn>();
-        Value result = std::visit(
-            [&](auto&& func) -> Value {
-                using T = std::decay_t<decltype(func)>;
-                if constexpr (std::is_same_v<T, NativeFnSimple>) {
-                    return func(args);
-                } else if constexpr (std::is_same_v<T, NativeFnAdvanced>) {
-                    return func(this, args);
-                }
-                return Value(Null{});
-            },
-            func
-        );
-        if (dst != -1) stackSlots[base + dst] = result;
+        _finishNativeCall(callee.get<NativeFn>(), nullptr, dst, argStart, argc, base);
     } else {
         std::ostringstream os;
         os << "Giá trị kiểu '" << _toString(callee) << "' không thể gọi được: '" + _toString(callee) + "' ";
         os << "với các tham số là: ";
-        for (const auto& arg : args) {
-            os << _toString(arg) << " ";
+        for (Int i = 0; i < argc; ++i) {
+            os << _toString(stackSlots[base + argStart + i]) << " ";
         }
         os << "\n";
         throwVMError(os.str());
@@ -109,16 +149,27 @@ void MeowVM::_executeCall(const Value& callee, Int dst, Int argStart, Int argc,
 
 Value MeowVM::call(const Value& callee, Arguments args) {
     size_t startCallDepth = callStack.size();
+    ++nestedCalls;
+    struct NestedCallGuard {
+        Int& depth;
+        ~NestedCallGuard() { --depth; }
+    } nestedGuard{nestedCalls};
+
+    // Natives calling natives need no registers at all
+    if (auto native = callee.get_if<NativeFn>()) {
+        Value result = _callNative(*native, nullptr, args);
+        if (snapshotPending) _writeSnapshot();
+        return result;
+    }
 
+    // `args` may itself be a view into stackSlots, which growing never moves
     Int argStartAbs = static_cast<Int>(stackSlots.size());
-    stackSlots.resize(argStartAbs + static_cast<Int>(args.size()));
+    Int dstAbs = argStartAbs + static_cast<Int>(args.size());
+    _growStack(dstAbs + 1);
     for (size_t i = 0; i < args.size(); ++i) {
         stackSlots[argStartAbs + static_cast<Int>(i)] = args[i];
     }
 
-    Int dstAbs = static_cast<Int>(stackSlots.size());
-    stackSlots.resize(dstAbs + 1);
-
     Int argStartRel = argStartAbs - currentBase;
     Int dstRel      = dstAbs - currentBase;
     if (argStartRel < 0 || dstRel < -1) {
@@ -140,6 +191,7 @@ Value MeowVM::call(const Value& callee, Arguments args) {
                 size_t idx = static_cast<size_t>(parent.slotStart + currentFrame->retReg);
                 if (idx < stackSlots.size()) stackSlots[idx] = Value(Null{});
             }
+            closeUpvalues(currentBase);
             callStack.pop_back();
             continue;
         }
@@ -157,6 +209,6 @@ Value MeowVM::call(const Value& callee, Arguments args) {
 
     Value result = stackSlots[dstAbs];
 
-    stackSlots.resize(argStartAbs);
+    _setStackTop(argStartAbs);
     return result;
 }
\ No newline at end of file
@@ -1,21 +1,9 @@
 #include "vm/meow_vm.h"
 
-// Helper: tạo wrapper cho native function, push receiver vào đầu args
-static NativeFnAdvanced make_native_wrapper(NativeFn orig, Value receiver) {
-    return [orig, receiver](MeowEngine* engine, Arguments args) -> Value {
-        std::vector<Value> newArgs;
-        newArgs.reserve(1 + args.size());
-        newArgs.push_back(receiver);
-        newArgs.insert(newArgs.end(), args.begin(), args.end());
-        return std::visit([&](auto&& fn) -> Value {
-            using T = std::decay_t<decltype(fn)>;
-            if constexpr (std::is_same_v<T, NativeFnSimple>) {
-                return fn(newArgs);
-            } else {
-                return fn(engine, newArgs);
-            }
-        }, orig);
-    };
+// Helper: gắn receiver vào native function (xem MeowVM::_callNative); native đã gắn thì được gắn lại
+static Value bindNative(const NativeFn& native, const Value& receiver) {
+    const NativeFn& function = std::holds_alternative<BoundNative>(native) ? std::get<BoundNative>(native)->function : native;
+    return Value(NativeFn(std::make_shared<const BoundNativeFn>(BoundNativeFn{ function, receiver })));
 }
 
 // Helper: nếu receiver là Instance thì bind function/bound_method -> ObjBoundMethod;
@@ -38,9 +26,7 @@ std::optional<Value> wrapValueForInstance(Instance inst, const Value& v, MemoryM
     }
 
     if (v.is_native_fn()) {
-        NativeFn orig = v.get<NativeFn>();
-        NativeFnAdvanced wrapper = make_native_wrapper(orig, Value(inst));
-        return Value(wrapper);
+        return bindNative(v.get<NativeFn>(), Value(inst));
     }
 
     return Value(v);
@@ -51,9 +37,7 @@ std::optional<Value> wrapValueForInstance(Instance inst, const Value& v, MemoryM
 // - ngược lại trả Value as-is
 std::optional<Value> wrapValueWithReceiverValue(const Value& receiver, const Value& v) {
     if (v.is_native_fn()) {
-        NativeFn orig = v.get<NativeFn>();
-        NativeFnAdvanced wrapper = make_native_wrapper(orig, receiver);
-        return Value(wrapper);
+        return bindNative(v.get<NativeFn>(), receiver);
     }
     return Value(v);
 }
@@ -66,20 +50,13 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
         if (!inst) return std::nullopt;
 
         // 1) instance fields
-        auto fit = inst->fields.find(name);
-        if (fit != inst->fields.end()) {
-            if (auto r = wrapValueForInstance(inst, fit->second, memoryManager.get())) return *r;
+        if (Value* field = inst->getField(name)) {
+            if (auto r = wrapValueForInstance(inst, *field, memoryManager.get())) return *r;
         }
 
-        // 2) class methods (including walking superclass)
-        Class cur = inst->klass;
-        while (cur) {
-            auto mit = cur->methods.find(name);
-            if (mit != cur->methods.end()) {
-                if (auto r = wrapValueForInstance(inst, mit->second, memoryManager.get())) return *r;
-            }
-            if (cur->superclass) cur = *cur->superclass;
-            else break;
+        // 2) class methods (flattened over the superclass chain)
+        if (auto method = findClassMethod(inst->klass, name)) {
+            if (auto r = wrapValueForInstance(inst, *method, memoryManager.get())) return *r;
         }
 
         return std::nullopt;
@@ -90,15 +67,14 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
         Object objPtr = obj.get<Object>();
         if (!objPtr) return std::nullopt;
 
-        auto fit = objPtr->fields.find(name);
-        if (fit != objPtr->fields.end()) {
-            if (auto r = wrapValueWithReceiverValue(Value(objPtr), fit->second)) return *r;
+        if (Value* field = objPtr->fields.findString(name)) {
+            if (auto r = wrapValueWithReceiverValue(Value(objPtr), *field)) return *r;
         }
 
         auto pgit = builtinGetters.find("Object");
         if (pgit != builtinGetters.end()) {
             auto it = pgit->second.find(name);
-            if (it != pgit->second.end()) return this->call(it->second, { obj });
+            if (it != pgit->second.end()) return _callGetter(it->second, obj);
         }
         auto pit = builtinMethods.find("Object");
         if (pit != builtinMethods.end()) {
@@ -118,7 +94,7 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
         auto pgit = builtinGetters.find("Array");
         if (pgit != builtinGetters.end()) {
             auto it = pgit->second.find(name);
-            if (it != pgit->second.end()) return this->call(it->second, { obj });
+            if (it != pgit->second.end()) return _callGetter(it->second, obj);
         }
         auto pit = builtinMethods.find("Array");
         if (pit != builtinMethods.end()) {
@@ -130,12 +106,31 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
         return std::nullopt;
     }
 
-    // --- STRING ---
-    if (obj.is_string()) {
+    // --- TYPED ARRAY (Int64Array / Float64Array) ---
+    if (obj.is_typed_array()) {
+        Str typeName = obj.get<TypedArray>()->typeName();
+
+        auto pgit = builtinGetters.find(typeName);
+        if (pgit != builtinGetters.end()) {
+            auto it = pgit->second.find(name);
+            if (it != pgit->second.end()) return _callGetter(it->second, obj);
+        }
+        auto pit = builtinMethods.find(typeName);
+        if (pit != builtinMethods.end()) {
+            auto it = pit->second.find(name);
+            if (it != pit->second.end()) {
+                if (auto r = wrapValueWithReceiverValue(obj, it->second)) return *r;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // --- STRING (String natives accept both Str and Rope receivers) ---
+    if (obj.is_string() || obj.is_rope()) {
         auto pgit = builtinGetters.find("String");
         if (pgit != builtinGetters.end()) {
             auto it = pgit->second.find(name);
-            if (it != pgit->second.end()) return this->call(it->second, { obj });
+            if (it != pgit->second.end()) return _callGetter(it->second, obj);
         }
         auto pit = builtinMethods.find("String");
         if (pit != builtinMethods.end()) {
@@ -157,7 +152,7 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
         auto pgit = builtinGetters.find(typeName);
         if (pgit != builtinGetters.end()) {
             auto it = pgit->second.find(name);
-            if (it != pgit->second.end()) return this->call(it->second, { obj });
+            if (it != pgit->second.end()) return _callGetter(it->second, obj);
         }
 
         auto pit = builtinMethods.find(typeName);
@@ -174,19 +169,84 @@ std::optional<Value> MeowVM::getMagicMethod(const Value& obj, const Str& name) {
     if (obj.is_class()) {
         Class klass = obj.get<Class>();
         if (!klass) return std::nullopt;
-        auto mit = klass->methods.find(name);
-        if (mit != klass->methods.end()) {
-            return Value(mit->second);
+        if (auto method = findClassMethod(klass, name)) {
+            return *method;
         }
     }
 
     return std::nullopt;
 }
 
-void MeowVM::register_method(const Str& type_name, const Str& method_name, const Value& method) noexcept {
-    builtinMethods[type_name][method_name] = method;
+std::optional<Value> MeowVM::findClassMethod(Class klass, const Str& name) {
+    if (!klass) return std::nullopt;
+    if (const Value* method = klass->findMethod(name, classEpoch)) return *method;
+    return std::nullopt;
 }
 
-void MeowVM::register_getter(const Str& type_name, const Str& property_name, const Value& getter) noexcept {
-    builtinGetters[type_name][property_name] = getter;
+// Getter native nhận receiver trực tiếp, không tạo mảng tham số
+Value MeowVM::_callGetter(const Value& getter, const Value& receiver) {
+    if (auto native = getter.get_if<NativeFn>()) return _callNative(*native, &receiver, {});
+    return this->call(getter, { receiver });
+}
+
+const Value* MeowVM::_findBuiltinMethod(const Value& obj, const Str& name) {
+    const char* typeName;
+    if (obj.is_hash()) {
+        Object object = obj.get<Object>();
+        if (!object || object->fields.findString(name)) return nullptr;
+        typeName = "Object";
+    } else if (obj.is_array()) {
+        if (!obj.get<Array>()) return nullptr;
+        typeName = "Array";
+    } else if (obj.is_typed_array()) {
+        typeName = obj.get<TypedArray>()->typeName();
+    } else if (obj.is_string() || obj.is_rope()) {
+        typeName = "String";
+    } else if (obj.is_int()) {
+        typeName = "Int";
+    } else if (obj.is_real()) {
+        typeName = "Real";
+    } else if (obj.is_bool()) {
+        typeName = "Bool";
+    } else {
+        return nullptr;
+    }
+
+    Str type(typeName);
+    if (auto getters = builtinGetters.find(type); getters != builtinGetters.end() && getters->second.count(name)) return nullptr;
+    auto methods = builtinMethods.find(type);
+    if (methods == builtinMethods.end()) return nullptr;
+    auto it = methods->second.find(name);
+    return it != methods->second.end() && it->second.is_native_fn() ? &it->second : nullptr;
+}
+
+Value MeowVM::bindMethod(Instance inst, const Value& method) {
+    if (auto r = wrapValueForInstance(inst, method, memoryManager.get())) return *r;
+    return method;
+}
+
+void MeowVM::register_method(const Str& type_name, const Str& method_name, const Value& method) {
+    builtinMethods[type_name][method_name] = _snapshotMethod(type_name, method_name, method);
+}
+
+void MeowVM::register_getter(const Str& type_name, const Str& property_name, const Value& getter) {
+    builtinGetters[type_name][property_name] = _snapshotGetter(type_name, property_name, getter);
+}
+
+void MeowVM::register_methods(const Str& type_name, std::initializer_list<NativeBinding> methods) {
+    auto& table = builtinMethods[type_name];
+    table.reserve(table.size() + methods.size());
+    for (const NativeBinding& method : methods) {
+        Str name(method.name);
+        table.insert_or_assign(name, _snapshotMethod(type_name, name, method.function));
+    }
+}
+
+void MeowVM::register_getters(const Str& type_name, std::initializer_list<NativeBinding> getters) {
+    auto& table = builtinGetters[type_name];
+    table.reserve(table.size() + getters.size());
+    for (const NativeBinding& getter : getters) {
+        Str name(getter.name);
+        table.insert_or_assign(name, _snapshotGetter(type_name, name, getter.function));
+    }
 }
\ No newline at end of file
@@ -25,41 +25,36 @@ Str MeowVM::_toString(const Value& v) {
         return trimTrailingZeros(ss.str());
     }
     if (v.is_string()) return v.get<Str>();
+    if (v.is_rope()) {
+        Str out;
+        v.get<Rope>()->appendTo(out);
+        return out;
+    }
     if (v.is_instance()) {
         const auto& inst = v.get<Instance>();
-        auto it = inst->fields.find("__str__");
-        if (it != inst->fields.end()) {
+        Value* strField = inst->getField("__str__");
+        if (strField) {
 
             try {
-                Function func = it->second.get<Function>();
+                Function func = strField->get<Function>();
                 BoundMethod bound = memoryManager->newObject<ObjBoundMethod>(inst, func);
                 Value str = this->call(Value(bound), {});
-                if (str.is_string()) return str.get<Str>();
+                if (str.is_string() || str.is_rope()) return _toString(str);
 
             } catch (...) {
 
             }
         } else {
 
-            auto currentClass = inst->klass;
-            while (currentClass) {
-                auto mIt = currentClass->methods.find("__str__");
-                if (mIt != currentClass->methods.end()) {
+            if (auto method = findClassMethod(inst->klass, "__str__")) {
 
-                    try {
-                        Function func = mIt->second.get<Function>();
-                        BoundMethod bound = memoryManager->newObject<ObjBoundMethod>(inst, func);
-                        Value str = this->call(Value(bound), {});
-                        if (str.is_string()) return str.get<Str>();
-                    } catch (...) {
+                try {
+                    Function func = method->get<Function>();
+                    BoundMethod bound = memoryManager->newObject<ObjBoundMethod>(inst, func);
+                    Value str = this->call(Value(bound), {});
+                    if (str.is_string() || str.is_rope()) return _toString(str);
+                } catch (...) {
 
-                    }
-                    break;
-                }
-                if (currentClass->superclass) {
-                    currentClass = *currentClass->superclass;
-                } else {
-                    break;
                 }
             }
         }
@@ -73,7 +68,17 @@ Str MeowVM::_toString(const Value& v) {
         Str out = "[";
         for (size_t i = 0; i < vec->size(); ++i) {
             if (i > 0) out += ", ";
-            out += _toString((*vec)[i]);
+            out += _toString(vec->get(i));
+        }
+        out += "]";
+        return out;
+    }
+    if (v.is_typed_array()) {
+        TypedArray arr = v.get<TypedArray>();
+        Str out = Str(arr->typeName()) + "[";
+        for (size_t i = 0; i < arr->size(); ++i) {
+            if (i > 0) out += ", ";
+            out += _toString(arr->get(i));
         }
         out += "]";
         return out;
@@ -82,11 +87,11 @@ Str MeowVM::_toString(const Value& v) {
         const auto& m = v.get<Object>()->fields;
         Str out = "{";
         Bool first = true;
-        for (const auto& pair : m) {
+        m.forEach([&](const Value& key, const Value& value) {
             if (!first) out += ", ";
-            out += pair.first + ": " + _toString(pair.second);
+            out += _toString(key) + ": " + _toString(value);
             first = false;
-        }
+        });
         out += "}";
         return out;
     }
@@ -146,11 +151,13 @@ Str MeowVM::_toString(const Value& v) {
             }
             if (val.is_bool()) return val.get<Bool>() ? "true" : "false";
             if (val.is_string()) return Str("\"") + val.get<Str>() + Str("\"");
+            if (val.is_rope()) return Str("\"") + _toString(val) + Str("\"");
             if (val.is_proto()) return "<function proto>";
             if (val.is_function()) return "<closure>";
             if (val.is_instance()) return "<instance>";
             if (val.is_class()) return "<class>";
             if (val.is_array()) return "<array>";
+            if (val.is_typed_array()) return "<typed array>";
             if (val.is_hash()) return "<object>";
             if (val.is_upvalue()) return "<upvalue>";
             if (val.is_module()) return "<module>";
@@ -182,6 +189,7 @@ Int MeowVM::_toInt(const Value& v) const {
         return static_cast<Int>(r);
     }
     if (v.is_bool()) return v.get<Bool>() ? 1 : 0;
+    if (v.is_rope()) return _toInt(Value(v.get<Rope>()->flatten()));
     if (v.is_string()) {
         const Str sfull = v.get<Str>();
 
@@ -254,6 +262,7 @@ Real MeowVM::_toDouble(const Value& v) const {
     if (v.is_real()) return v.get<Real>();
     if (v.is_int()) return static_cast<Real>(v.get<Int>());
     if (v.is_bool()) return v.get<Bool>() ? 1.0 : 0.0;
+    if (v.is_rope()) return _toDouble(Value(v.get<Rope>()->flatten()));
     if (v.is_string()) {
         Str s = v.get<Str>();
 
@@ -283,11 +292,47 @@ Bool MeowVM::_isTruthy(const Value& v) const {
         return r != 0.0 && !std::isnan(r);
     }
     if (v.is_string()) return !v.get<Str>().empty();
+    if (v.is_rope()) return !v.get<Rope>()->empty();
     if (v.is_array()) return !v.get<Array>()->empty();
+    if (v.is_typed_array()) return !v.get<TypedArray>()->empty();
     if (v.is_hash()) return !v.get<Object>()->fields.empty();
     return true;
 }
 
+// One-character strings for every byte value, built once, so indexing a string never builds a Str
+const Value& MeowVM::_charValue(char c) const noexcept {
+    static const std::array<Value, 256> table = [] {
+        std::array<Value, 256> chars;
+        for (size_t i = 0; i < chars.size(); ++i) chars[i] = Value(Str(1, static_cast<char>(i)));
+        return chars;
+    }();
+    return table[static_cast<unsigned char>(c)];
+}
+
+// Long strings move into a flat rope on first character access, so their character index is built once
+void MeowVM::_promoteString(Value& v) {
+    if (v.is_string() && v.get<Str>().size() >= ObjRope::MIN_LENGTH) {
+        Rope rope = memoryManager->newObject<ObjRope>(std::move(v.get<Str>()));
+        v = Value(rope);
+    }
+}
+
+// Ropes keep their character index; for a Str it is built into `scratch`
+const Utf8Index& MeowVM::_utf8Index(const Value& v, Utf8Index& scratch) {
+    if (v.is_rope()) return v.get<Rope>()->utf8();
+    scratch = Utf8Index(v.get<Str>());
+    return scratch;
+}
+
+std::string_view MeowVM::_stringView(const Value& v) {
+    return v.is_rope() ? v.get<Rope>()->view() : std::string_view(v.get<Str>());
+}
+
+// For paths that need a contiguous Str in the register (indexing, hash keys, string methods)
+void MeowVM::_flattenRope(Value& v) {
+    if (v.is_rope()) v = Value(v.get<Rope>()->flatten());
+}
+
 Str MeowVM::opToString(OpCode op) const {
     switch (op) {
         case OpCode::LOAD_CONST: return "LOAD_CONST";
@@ -328,6 +373,8 @@ Str MeowVM::opToString(OpCode op) const {
         case OpCode::SET_INDEX: return "SET_INDEX";
         case OpCode::GET_KEYS: return "GET_KEYS";
         case OpCode::GET_VALUES: return "GET_VALUES";
+        case OpCode::ITER_INIT: return "ITER_INIT";
+        case OpCode::ITER_NEXT: return "ITER_NEXT";
         case OpCode::NEW_CLASS: return "NEW_CLASS";
         case OpCode::NEW_INSTANCE: return "NEW_INSTANCE";
         case OpCode::GET_PROP: return "GET_PROP";
@@ -371,11 +418,13 @@ void MeowVM::throwVMError(const Str& msg) {
         }
         if (v.is_bool()) return v.get<Bool>() ? "true" : "false";
         if (v.is_string()) return Str("\"") + v.get<Str>() + Str("\"");
+        if (v.is_rope()) return Str("\"") + _toString(v) + Str("\"");
         if (v.is_proto()) return "<function proto>";
         if (v.is_function()) return "<closure>";
         if (v.is_instance()) return "<instance>";
         if (v.is_class()) return "<class>";
         if (v.is_array()) return "<array>";
+        if (v.is_typed_array()) return "<typed array>";
         if (v.is_hash()) return "<object>";
         if (v.is_upvalue()) return "<upvalue>";
         if (v.is_module()) return "<module>";
@@ -1,4 +1,5 @@
 #include "meow_vm.h"
+#include "mapped_file.h"
 #include "common/pch.h"
 
 #if defined(_WIN32)
@@ -7,108 +8,6 @@
 #include <dlfcn.h>
 #endif
 
-#if !defined(_WIN32)
-#include <unistd.h>
-#include <limits.h>
-#endif
-#if defined(__APPLE__)
-#include <mach-o/dyld.h>
-#endif
-
-// --- helper: lấy thư mục chứa executable (cross-platform) ---
-static std::filesystem::path getExecutableDir() {
-#if defined(_WIN32)
-    char buf[MAX_PATH];
-    DWORD len = GetModuleFileNameA(NULL, buf, MAX_PATH);
-    if (len == 0) throw std::runtime_error("GetModuleFileNameA failed");
-    return std::filesystem::path(std::string(buf, static_cast<size_t>(len))).parent_path();
-#elif defined(__linux__)
-    char buf[PATH_MAX];
-    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
-    if (len == -1) throw std::runtime_error("readlink(/proc/self/exe) failed");
-    buf[len] = '\0';
-    return std::filesystem::path(std::string(buf)).parent_path();
-#elif defined(__APPLE__)
-    uint32_t size = 0;
-    _NSGetExecutablePath(nullptr, &size); // will set size
-    std::vector<char> buf(size);
-    if (_NSGetExecutablePath(buf.data(), &size) != 0) {
-        throw std::runtime_error("_NSGetExecutablePath failed");
-    }
-    std::filesystem::path p(buf.data());
-    return std::filesystem::absolute(p).parent_path();
-#else
-    return std::filesystem::current_path();
-#endif
-}
-
-// --- helper: expand token $ORIGIN in a path string to exeDir ---
-static std::string expandOriginToken(const std::string& raw, const std::filesystem::path& exeDir) {
-    std::string out;
-    const std::string token = "$ORIGIN";
-    size_t pos = 0;
-    while (true) {
-        size_t p = raw.find(token, pos);
-        if (p == std::string::npos) {
-            out.append(raw.substr(pos));
-            break;
-        }
-        out.append(raw.substr(pos, p - pos));
-        out.append(exeDir.string());
-        pos = p + token.size();
-    }
-    return out;
-}
-
-// --- detect stdlib root: đọc file meow-root cạnh binary (1 lần, cached) ---
-static std::filesystem::path detectStdlibRoot_cached() {
-    static std::optional<std::filesystem::path> cached;
-    if (cached.has_value()) return *cached;
-
-    std::filesystem::path result;
-    try {
-        std::filesystem::path exeDir = getExecutableDir(); // thư mục chứa binary
-        std::filesystem::path configFile = exeDir / "meow-root";
-
-        // 1) nếu có file meow-root, đọc và expand $ORIGIN
-        if (std::filesystem::exists(configFile)) {
-            std::ifstream in(configFile);
-            if (in) {
-                std::string line;
-                std::getline(in, line);
-                // trim (simple)
-                while (!line.empty() && (line.back() == '\n' || line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
-                size_t i = 0;
-                while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
-                if (i > 0) line = line.substr(i);
-
-                if (!line.empty()) {
-                    std::string expanded = expandOriginToken(line, exeDir);
-                    result = std::filesystem::absolute(std::filesystem::path(expanded));
-                    cached = result;
-                    return result;
-                }
-            }
-        }
-
-        // 2) fallback nhanh: nếu exeDir là "bin", dùng parent; ngược lại dùng exeDir
-        if (exeDir.filename() == "bin") {
-            result = exeDir.parent_path();
-        } else {
-            result = exeDir;
-        }
-
-        // 3) nếu không tìm thấy stdlib trực tiếp ở root, có thể thử root/lib
-        cached = std::filesystem::absolute(result);
-        return *cached;
-    } catch (...) {
-        // fallback to current path nếu có gì sai
-        cached = std::filesystem::current_path();
-        return *cached;
-    }
-}
-
-
 static std::string platformLastError() {
 #if defined(_WIN32)
     DWORD err = GetLastError();
@@ -126,126 +25,58 @@ static std::string platformLastError() {
 #endif
 }
 
-Module MeowVM::_getOrLoadModule(const Str& modulePath, const Str& importerPath, Bool isBinary) {
-    if (auto it = moduleCache.find(modulePath); it != moduleCache.end()) {
-        return it->second;
+Module MeowVM::_loadNativeLibrary(const Str& libPath) {
+    if (NativeModuleFactory factory = NativeModuleRegistry::find(libPath)) {
+        Module nativeModule = factory(this);
+        if (!snapshotPath.empty()) _tagLibraryNatives(nativeModule, libPath);
+        return nativeModule;
     }
 
+    void* handle = nullptr;
 #if defined(_WIN32)
-    Str libExtension = ".dll";
-#elif defined(__APPLE__)
-    Str libExtension = ".dylib";
+    handle = (void*)LoadLibraryA(libPath.c_str());
 #else
-    Str libExtension = ".so";
+    dlerror();
+    handle = dlopen(libPath.c_str(), RTLD_LAZY);
 #endif
+    if (!handle) {
+        std::string detail = platformLastError();
+        throw VMError("Không thể tải thư viện native: " + libPath + (detail.empty() ? "" : (" - " + detail)));
+    }
 
-    auto resolveLibraryPath = [&](const Str& modPath, const Str& importer) -> Str {
-        try {
-            std::filesystem::path candidate(modPath);
-            std::string ext = candidate.extension().string();
-
-            if (!ext.empty()) {
-                std::string extLower = ext;
-                for (char &c : extLower) c = (char)std::tolower((unsigned char)c);
-                if (extLower == ".meow" || extLower == ".meowb") {
-                    return "";
-                }
-            }
-
-            if (candidate.extension().empty()) {
-                candidate.replace_extension(libExtension);
-            }
-
-            if (candidate.is_absolute() && std::filesystem::exists(candidate)) {
-                return std::filesystem::absolute(candidate).lexically_normal().string();
-            }
-
-            std::filesystem::path stdlibRoot = detectStdlibRoot_cached();
-            std::filesystem::path stdlibPath = stdlibRoot / candidate;
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-            // thử dưới stdlibRoot/lib/candidate
-            stdlibPath = stdlibRoot / "lib" / candidate;
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-            // thử dưới stdlibRoot/stdlib/candidate
-            stdlibPath = stdlibRoot / "stdlib" / candidate;
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-            // --- bổ sung: nhiều dự án đặt stdlib trong bin/stdlib hoặc stdlib trong bin ---
-            stdlibPath = stdlibRoot / "bin" / "stdlib" / candidate;
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-            stdlibPath = stdlibRoot / "bin" / candidate;
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-            // optional: nếu meow-root thực sự trỏ lên một level, vẫn thử parent/bin/stdlib
-            stdlibPath = std::filesystem::absolute(stdlibRoot / ".." / "bin" / "stdlib" / candidate);
-            if (std::filesystem::exists(stdlibPath)) {
-                return std::filesystem::absolute(stdlibPath).lexically_normal().string();
-            }
-
-
-
-            std::filesystem::path baseDir = (importer == entryPointDir)
-                ? std::filesystem::path(entryPointDir)
-                : std::filesystem::path(importer).parent_path();
+    NativeModuleFactory factory = nullptr;
+#if defined(_WIN32)
 
-            std::filesystem::path relativePath = std::filesystem::absolute(baseDir / candidate);
-            if (std::filesystem::exists(relativePath)) {
-                return relativePath.lexically_normal().string();
-            }
+    auto procAddress = GetProcAddress((HMODULE)handle, "CreateMeowModule");
 
-            return "";
-        } catch (const std::exception& ex) {
-            return "";
-        }
-    };
+    if (procAddress == nullptr) {
+        std::string detail = platformLastError();
+        throw VMError("Không tìm thấy cổng giao tiếp 'CreateMeowModule' trong " + libPath + (detail.empty() ? "" : (" - " + detail)));
+    }
 
-    Str libPath = resolveLibraryPath(modulePath, importerPath);
+    factory = reinterpret_cast<NativeModuleFactory>(procAddress);
 
-    if (!libPath.empty()) {
-        void* handle = nullptr;
-#if defined(_WIN32)
-        handle = (void*)LoadLibraryA(libPath.c_str());
 #else
-        dlerror();
-        handle = dlopen(libPath.c_str(), RTLD_LAZY);
+    dlerror();
+    factory = (NativeModuleFactory)dlsym(handle, "CreateMeowModule");
 #endif
-        if (!handle) {
-            std::string detail = platformLastError();
-            throw VMError("Không thể tải thư viện native: " + libPath + (detail.empty() ? "" : (" - " + detail)));
-        }
-
-        using NativeFunction = Module(*)(MeowEngine*);
-        NativeFunction factory = nullptr;
-#if defined(_WIN32)
 
-        auto procAddress = GetProcAddress((HMODULE)handle, "CreateMeowModule");
-
-        if (procAddress == nullptr) {
-            std::string detail = platformLastError();
-            throw VMError("Không tìm thấy cổng giao tiếp 'CreateMeowModule' trong " + libPath + (detail.empty() ? "" : (" - " + detail)));
-        }
+    Module nativeModule = factory(this);
+    if (!snapshotPath.empty()) _tagLibraryNatives(nativeModule, libPath);
+    return nativeModule;
+}
 
-        factory = reinterpret_cast<NativeFunction>(procAddress);
+Module MeowVM::_getOrLoadModule(const Str& modulePath, const Str& importerPath, Bool isBinary) {
+    if (auto it = moduleCache.find(modulePath); it != moduleCache.end()) {
+        return it->second;
+    }
 
-#else
-        dlerror();
-        factory = (NativeFunction)dlsym(handle, "CreateMeowModule");
-#endif
+    // Modules linked into the executable shadow any library file of the same name
+    Str libPath = NativeModuleRegistry::find(modulePath) ? modulePath : moduleResolver.resolveLibrary(modulePath, importerPath);
 
-        Module nativeModule = factory(this);
+    if (!libPath.empty()) {
+        Module nativeModule = _loadNativeLibrary(libPath);
+        nativeLibraries.push_back(libPath);
 
         moduleCache[modulePath] = nativeModule;
         moduleCache[libPath] = nativeModule;
@@ -253,23 +84,30 @@ Module MeowVM::_getOrLoadModule(const Str& modulePath, const Str& importerPath,
         return nativeModule;
     }
 
-    std::filesystem::path baseDir = (importerPath == entryPointDir)
-        ? std::filesystem::path(entryPointDir)
-        : std::filesystem::path(importerPath).parent_path();
-    std::filesystem::path resolvedPath = std::filesystem::absolute(baseDir / modulePath);
-    Str absolutePath = resolvedPath.lexically_normal().string();
+    Str absolutePath = moduleResolver.resolveSource(modulePath, importerPath);
+    // Binary programs keep their text import specs: `import "x.meow"` loads the assembled x.meowb
+    if (isBinary && std::filesystem::path(absolutePath).extension() == ".meow") absolutePath += "b";
 
     if (auto it = moduleCache.find(absolutePath); it != moduleCache.end()) {
         return it->second;
     }
 
     std::unordered_map<Str, Proto> protos;
-    if (isBinary) {
-        // if (!binaryParser.parseFile(absolutePath, *memoryManager))
-        //     throw VMError("Binary parsing failed for file: " + absolutePath);
-        // protos = binaryParser.protos;
+    if (lazyLoading) {
+        Bool loaded = isBinary ? lazyLoader.parseBinaryFile(absolutePath, *memoryManager) : lazyLoader.parseTextFile(absolutePath, *memoryManager);
+        if (!loaded) throw VMError(Str(isBinary ? "Binary" : "Text") + " parsing failed for file: " + absolutePath);
+        protos = lazyLoader.protos;
+    } else if (isBinary) {
+        if (!binaryParser.parseFile(absolutePath, *memoryManager))
+            throw VMError("Binary parsing failed for file: " + absolutePath);
+        protos = binaryParser.protos;
     } else {
-        if (!textParser.parseFile(absolutePath, *memoryManager))
+        // Parsed in the background if an earlier module imports it; otherwise parse here and
+        // start prefetching its own imports before allocating anything
+        auto prefetched = modulePrefetcher.take(absolutePath);
+        ParsedModule parsed = prefetched ? std::move(*prefetched) : compileCache.readFile(absolutePath, textParser);
+        if (!prefetched) modulePrefetcher.prefetchImports(parsed.imports, absolutePath);
+        if (!textParser.materialize(std::move(parsed), *memoryManager))
             throw VMError("Text parsing failed for file: " + absolutePath);
         protos = textParser.protos;
     }
@@ -283,15 +121,80 @@ Module MeowVM::_getOrLoadModule(const Str& modulePath, const Str& importerPath,
     newModule->mainProto = pit->second;
     newModule->hasMain = true;
 
-    if (newModule->name != "native") {
-        auto itNative = moduleCache.find("native");
-        if (itNative != moduleCache.end()) {
-            for (const auto& [name, func] : itNative->second->globals) {
-                newModule->globals[name] = func;
-            }
-        }
-    }
+    newModule->builtins = builtinScope;
+    for (auto& [name, proto] : protos) newModule->link(proto);
 
     moduleCache[absolutePath] = newModule;
+    if (!newModule->mainProto->isLoaded()) _loadBody(newModule->mainProto);
     return newModule;
 }
+
+Module MeowVM::_loadLinkedProgram(const Str& path) {
+    MappedFile file;
+    if (!file.open(path)) throw VMError("Không thể mở chương trình liên kết: " + path);
+    std::string_view bytes = file.view();
+    auto invalid = [&](const Str& what) {
+        return VMError("Chương trình liên kết '" + path + "' không hợp lệ: " + what);
+    };
+
+    LinkedHeader header;
+    if (bytes.size() < sizeof(header)) throw invalid("file bị cắt cụt");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, LINKED_MAGIC, sizeof(LINKED_MAGIC)) != 0) throw invalid("không phải file .meowl");
+    if (header.version != LINKED_VERSION) throw invalid("phiên bản " + std::to_string(header.version) + " không được hỗ trợ");
+    if (header.fileSize != bytes.size() || header.moduleCount == 0 ||
+        header.modulesOffset > bytes.size() || header.moduleCount > (bytes.size() - header.modulesOffset) / sizeof(LinkedModule) ||
+        header.imageOffset > bytes.size() || header.imageSize > bytes.size() - header.imageOffset) {
+        throw invalid("bảng module hoặc image nằm ngoài file");
+    }
+    std::vector<LinkedModule> table(header.moduleCount);
+    std::memcpy(table.data(), bytes.data() + header.modulesOffset, sizeof(LinkedModule) * table.size());
+
+    BinaryModuleView image;
+    Str error;
+    if (!image.open(bytes.substr(header.imageOffset, header.imageSize), error)) throw invalid(error);
+    Uint32 protoCount = image.header().protoCount;
+    if (header.exportCount > image.header().stringCount) throw invalid("số export vượt quá bảng chuỗi");
+    linkedExportCount = static_cast<Int>(header.exportCount);
+
+    // Every module of the program is materialised up front; nothing is rooted until it is in the module cache
+    memoryManager->disableGC();
+    struct EnableGC {
+        MemoryManager& heap;
+        ~EnableGC() { heap.enableGC(); }
+    } enableGC{*memoryManager};
+
+    std::unordered_map<Str, Proto> protos;
+    std::vector<Proto> byIndex;
+    if (!BinaryParser::allocateProtos(image, *memoryManager, protos, byIndex, error)) throw invalid(error);
+    for (Uint32 i = 0; i < protoCount; ++i) {
+        if (!BinaryParser::loadBody(image, i, byIndex, *byIndex[i], error)) throw invalid(error);
+    }
+    for (Proto proto : byIndex) proto->attachInlineCaches();
+
+    std::filesystem::path baseDir = std::filesystem::absolute(path).parent_path();
+    Module entry = nullptr;
+    for (const LinkedModule& record : table) {
+        std::string_view key;
+        if (!image.string(record.path, key)) throw invalid("đường dẫn module không hợp lệ");
+        if (record.firstProto > protoCount || record.protoCount > protoCount - record.firstProto ||
+            record.mainProto < record.firstProto || record.mainProto - record.firstProto >= record.protoCount) {
+            throw invalid("dải hàm của module '" + Str(key) + "' nằm ngoài image");
+        }
+        Str modulePath = (baseDir / key).lexically_normal().string();
+        auto module = memoryManager->newObject<ObjModule>(Str(key), modulePath, true);
+        module->mainProto = byIndex[record.mainProto];
+        module->hasMain = true;
+        module->builtins = builtinScope;
+        for (Uint32 i = record.firstProto; i < record.firstProto + record.protoCount; ++i) module->link(byIndex[i]);
+        moduleCache[module->name] = module;
+        moduleCache[module->path] = module;
+        if (!entry) entry = module;
+    }
+    return entry;
+}
+
+void MeowVM::_loadBody(Proto proto) {
+    Str error;
+    if (!proto->loadBody(error)) throw VMError("Không thể nạp thân hàm '" + proto->sourceName + "': " + error);
+}
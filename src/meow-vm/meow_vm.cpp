@@ -3,16 +3,18 @@
 #include "core/meow_object.h"
 // #include "gc_visitor.h"
 
-MeowVM::MeowVM(const Str& entryPointDir_) : entryPointDir(entryPointDir_) {
+MeowVM::MeowVM(const Str& entryPointDir_) : moduleResolver(entryPointDir_), entryPointDir(entryPointDir_) {
     memoryManager = std::make_unique<MemoryManager>(std::make_unique<MarkSweepGC>());
     memoryManager->setVM(this);
+    stackSlots.reserve(stackLimit);
     defineNativeFunctions();
     initializeJumpTable();
 }
 
-MeowVM::MeowVM(const Str& entryPointDir_, int argc, char* argv[]) : entryPointDir(entryPointDir_) {
+MeowVM::MeowVM(const Str& entryPointDir_, int argc, char* argv[]) : moduleResolver(entryPointDir_), entryPointDir(entryPointDir_) {
     memoryManager = std::make_unique<MemoryManager>(std::make_unique<MarkSweepGC>());
     memoryManager->setVM(this);
+    stackSlots.reserve(stackLimit);
     defineNativeFunctions();
     initializeJumpTable();
 
@@ -22,16 +24,29 @@ MeowVM::MeowVM(const Str& entryPointDir_, int argc, char* argv[]) : entryPointDi
     }
 }
 
+void MeowVM::setStackLimit(Int slots) {
+    if (slots <= 0 || slots > MAX_STACK_SLOTS) {
+        throw VMError("Giới hạn ngăn xếp phải từ 1 đến " + std::to_string(MAX_STACK_SLOTS) + " thanh ghi, nhận được " + std::to_string(slots));
+    }
+    stackLimit = slots;
+    std::vector<Value>().swap(stackSlots);
+    stackSlots.reserve(static_cast<size_t>(slots));
+}
+
 void MeowVM::interpret(const Str& entryPath, Bool isBinary) {
     callStack.clear();
     stackSlots.clear();
     openUpvalues.clear();
     moduleCache.clear();
     exceptionHandlers.clear();
-    defineNativeFunctions();
+    handleStack.clear();
+    moduleCache["native"] = builtinScope;
 
     try {
-        auto entryMod = _getOrLoadModule(entryPath, entryPointDir, isBinary);
+        // Linked programs (meow-link) carry all their modules; their imports never reach the resolver
+        auto entryMod = std::filesystem::path(entryPath).extension() == ".meowl"
+            ? _loadLinkedProgram(entryPath)
+            : _getOrLoadModule(entryPath, entryPointDir, isBinary);
 
         if (!entryMod->isExecuted) {
             if (!entryMod->hasMain) throw VMError("Entry module thiếu @main.");
@@ -39,7 +54,7 @@ void MeowVM::interpret(const Str& entryPath, Bool isBinary) {
 
             auto closure = memoryManager->newObject<ObjClosure>(entryMod->mainProto);
             Int base = static_cast<Int>(stackSlots.size());
-            stackSlots.resize(base + entryMod->mainProto->numRegisters, Value(Null{}));
+            _growStack(base + entryMod->mainProto->numRegisters);
             CallFrame frame(closure, base, entryMod, 0, -1);
             callStack.push_back(frame);
         }
@@ -61,6 +76,7 @@ void MeowVM::traceRoots(GCVisitor& visitor) {
     for (auto& pair : moduleCache) {
         visitor.visit_object(pair.second);
     }
+    visitor.visit_object(builtinScope);
 
     for (ObjUpvalue* upvalue : openUpvalues) {
         visitor.visit_object(upvalue);
@@ -81,32 +97,22 @@ void MeowVM::traceRoots(GCVisitor& visitor) {
             visitor.visit_value(getter_pair.second);
         }
     }
-}
 
-std::vector<Value*> MeowVM::findRoots() {
-    std::vector<Value*> roots;
-
-    for (Value& val : stackSlots) {
-        roots.push_back(&val);
+    // Values rooted by natives (and VM helpers) through HandleScope
+    for (Value& handle : handleStack) {
+        visitor.visit_value(handle);
     }
 
-    for (auto& pair : moduleCache) {
-        ObjModule* module = pair.second;
-        for (auto& global_pair : module->globals) {
-            roots.push_back(&global_pair.second);
-        }
-        for (auto& export_pair : module->exports) {
-            roots.push_back(&export_pair.second);
-        }
+    // Protos of a module that is still being loaded are not reachable from any module yet
+    for (auto& pair : textParser.protos) {
+        visitor.visit_object(pair.second);
     }
-
-    for (ObjUpvalue* upvalue : openUpvalues) {
-        if (upvalue->state == ObjUpvalue::State::CLOSED) {
-            roots.push_back(&upvalue->closed);
-        }
+    for (auto& pair : binaryParser.protos) {
+        visitor.visit_object(pair.second);
+    }
+    for (auto& pair : lazyLoader.protos) {
+        visitor.visit_object(pair.second);
     }
-
-    return roots;
 }
 
 void MeowVM::run() {
@@ -122,6 +128,8 @@ void MeowVM::run() {
                     stackSlots[parentFrame.slotStart + currentFrame->retReg] = Value(Null{});
                 }
             }
+            // The frame may sit on top of its caller's registers, so nothing may keep pointing at them
+            closeUpvalues(currentBase);
             callStack.pop_back();
             continue;
         }
@@ -137,10 +145,7 @@ void MeowVM::run() {
                 callStack.clear();
                 return;
             }
-            {
-                GCScopeGuard gcGuard(memoryManager.get());
-                (this->*jumpTable[opcode])();
-            }
+            (this->*jumpTable[opcode])();
 
         } catch (const VMError& e) {
             _handleRuntimeException(e);
@@ -163,7 +168,7 @@ void MeowVM::_handleRuntimeException(const VMError& e) {
         callStack.pop_back();
         closeUpvalues(currentFrame.slotStart);
     }
-    stackSlots.resize(handler.stackDepth);
+    _setStackTop(handler.stackDepth);
     CallFrame& currentFrame = callStack.back();
     currentFrame.ip = handler.catchIp;
     if (currentFrame.closure->proto->numRegisters > 0) {
@@ -235,6 +240,8 @@ void MeowVM::initializeJumpTable() {
     jumpTable[static_cast<Int32>(OpCode::SET_INDEX)] = &MeowVM::opSetIndex;
     jumpTable[static_cast<Int32>(OpCode::GET_KEYS)] = &MeowVM::opGetKeys;
     jumpTable[static_cast<Int32>(OpCode::GET_VALUES)] = &MeowVM::opGetValues;
+    jumpTable[static_cast<Int32>(OpCode::ITER_INIT)] = &MeowVM::opIterInit;
+    jumpTable[static_cast<Int32>(OpCode::ITER_NEXT)] = &MeowVM::opIterNext;
 
 
     jumpTable[static_cast<Int32>(OpCode::NEW_CLASS)] = &MeowVM::opNewClass;
@@ -8,7 +8,9 @@ void MeowVM::opClosure() {
         throwVMError("CLOSURE constant must be a FunctionProto.");
     }
     auto childProto = proto->constantPool[protoIdx].get<Proto>();
-    auto closure = memoryManager->newObject<ObjClosure>(childProto);
+    if (!childProto->isLoaded()) _loadBody(childProto);
+    HandleScope scope(this);
+    auto closure = scope.root(memoryManager->newObject<ObjClosure>(childProto));
 
     closure->upvalues.resize(childProto->upvalueDescs.size(), nullptr);
 
@@ -64,7 +66,7 @@ void MeowVM::opJumpIfTrue() {
 void MeowVM::opCall() {
     Int dst = currentInst->args[0], fnReg = currentInst->args[1], argStart = currentInst->args[2], argc = currentInst->args[3];
     auto& callee = stackSlots[currentBase + fnReg];
-    _executeCall(callee, dst, argStart, argc, currentBase);
+    _executeCall(callee, dst, argStart, argc, currentBase, currentInst->firstDead);
 }
 
 void MeowVM::opReturn() {
@@ -88,19 +90,11 @@ void MeowVM::opReturn() {
     if (caller.closure && caller.closure->proto) {
         callerRegs = caller.closure->proto->numRegisters;
     } 
-    Int minSize = callerBase + std::max<Int>(callerRegs, 1);
-    if (static_cast<Int>(stackSlots.size()) < minSize) {
-        stackSlots.resize(minSize, Value(Null{}));
-    } else {
-        stackSlots.resize(minSize);
-    }
+    _setStackTop(callerBase + std::max<Int>(callerRegs, 1));
 
     Int destReg = poppedFrame.retReg;
     if (destReg != -1) {
-        Int need = callerBase + destReg + 1;
-        if (static_cast<Int>(stackSlots.size()) < need) {
-            stackSlots.resize(need, Value(Null{}));
-        }
+        _growStack(callerBase + destReg + 1);
         stackSlots[callerBase + destReg] = retVal;
     }
 
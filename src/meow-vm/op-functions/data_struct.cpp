@@ -1,21 +1,19 @@
 #include "meow_vm.h"
 
 void MeowVM::opNewArray() {
-    size_t dst = currentInst->args[0],
-           start_idx = currentInst->args[1],
-           count = currentInst->args[2];
+    Int dst = currentInst->args[0],
+        start_idx = currentInst->args[1],
+        count = currentInst->args[2];
     if (count < 0 || start_idx < 0) {
         throwVMError("NEW_ARRAY: invalid range");
     }
-    if (currentBase + start_idx + count > stackSlots.size()) {
+    if (currentBase + start_idx + count > static_cast<Int>(stackSlots.size())) {
         throwVMError("NEW_ARRAY: register range OOB");
     }
 
+    // append() settles the elements kind before reserving, so only the storage that is used gets allocated
     Array array = memoryManager->newObject<ObjArray>();
-    array->reserve(count);
-    for (size_t i = 0; i < count; ++i) {
-        array->push(stackSlots[currentBase + start_idx + 1]);
-    }
+    array->append(stackSlots.data() + currentBase + start_idx, static_cast<size_t>(count));
     stackSlots[currentBase + dst] = Value(array);
 }
 
@@ -25,11 +23,15 @@ void MeowVM::opNewHash() {
     if (currentBase + startIdx + count*2 > static_cast<Int>(stackSlots.size()))
         throwVMError("NEW_HASH: register range OOB");
 
-    Object hm = memoryManager->newObject<ObjObject>();
+    HandleScope scope(this);
+    Object hm = scope.root(memoryManager->newObject<ObjObject>());
+    hm->fields.reserve(static_cast<size_t>(count));
     for (Int i = 0; i < count; ++i) {
         Value& key = stackSlots[currentBase + startIdx + i * 2];
         Value& val = stackSlots[currentBase + startIdx + i * 2 + 1];
-        hm->fields[_toString(key)] = val;
+        _flattenRope(key);  // rope keys must hash and compare like the equal Str
+        if (!ValueTable::isHashable(key)) throwVMError("NEW_HASH: unhashable key '" + _toString(key) + "'");
+        hm->fields[key] = val;
     }
     stackSlots[currentBase + dst] = Value(hm);
 }
@@ -46,6 +48,17 @@ void MeowVM::opGetIndex() {
 
     Value& src = stackSlots[currentBase + srcReg];
     Value& key = stackSlots[currentBase + keyReg];
+    _flattenRope(key);
+
+    if (src.is_typed_array() && key.is_int()) {
+        TypedArray arr = src.get<TypedArray>();
+        Int idx = key.get<Int>();
+        if (idx < 0 || idx >= static_cast<Int>(arr->size())) {
+            throwVMError("Chỉ số vượt quá phạm vi: '" + std::to_string(idx) + "' trên " + arr->typeName());
+        }
+        stackSlots[currentBase + dst] = arr->get(static_cast<size_t>(idx));
+        return;
+    }
 
 
     // if (auto mm = getMagicMethod(src, "__getindex__")) {
@@ -65,31 +78,43 @@ void MeowVM::opGetIndex() {
                 os << "  -  Được truy cập trên mảng: `\n" << _toString(arr) << "\n`";
                 throwVMError(os.str());
             }
-            stackSlots[currentBase + dst] = (*arr)[idx];
+            stackSlots[currentBase + dst] = arr->get(idx);
             return;
         }
-        if (src.is_string()) {
-            Str s = src.get<Str>();
-            if (idx < 0 || idx >= static_cast<Int>(s.size())) {
+        if (src.is_string() || src.is_rope()) {
+            // Reads in place: neither the string nor a rope's slice gets copied. Indices count
+            // characters, not bytes (see Utf8Index)
+            _promoteString(src);
+            Utf8Index scratch;
+            const Utf8Index& chars = _utf8Index(src, scratch);
+            std::string_view s = _stringView(src);
+            if (idx >= chars.length()) {
                 std::ostringstream os;
                 os << "  -  Chỉ số vượt quá phạm vi: '" << idx << "'. ";
-                os << "  -  Được truy cập trên string: `\n" << _toString(s) << "\n`\n";
+                os << "  -  Được truy cập trên string: `\n" << _toString(src) << "\n`\n";
                 throwVMError(os.str());
 
             }
-            stackSlots[currentBase + dst] = Value(Str(1, s[idx]));
+            std::string_view ch = chars.charAt(s, idx);
+            stackSlots[currentBase + dst] = ch.size() == 1 ? _charValue(ch[0]) : Value(Str(ch));
             return;
         }
         if (src.is_hash()) {
             Object m = src.get<Object>();
-            Str k = _toString(key);
-            auto it = m->fields.find(k);
-            stackSlots[currentBase + dst] = (it != m->fields.end()) ? it->second : Value(Null{});
+            Value* found = m->fields.find(key);
+            stackSlots[currentBase + dst] = found ? *found : Value(Null{});
             return;
         }
         throwVMError("Numeric index not supported on type '" + _toString(src) + "'");
     }
 
+    // Non-string keys address hash entries directly; string keys still go through the magic lookup below
+    if (src.is_hash() && !key.is_string()) {
+        Value* found = src.get<Object>()->fields.find(key);
+        stackSlots[currentBase + dst] = found ? *found : Value(Null{});
+        return;
+    }
+
 
     Str keyName = key.is_string() ? key.get<Str>() : _toString(key);
 
@@ -123,6 +148,21 @@ void MeowVM::opSetIndex() {
     Value& src = stackSlots[currentBase + srcReg];
     Value& key = stackSlots[currentBase + keyReg];
     Value& val = stackSlots[currentBase + valReg];
+    _flattenRope(key);
+    // Character writes keep a rope so its index survives; every other path wants a contiguous Str
+    if (!key.is_int()) _flattenRope(src);
+
+    if (src.is_typed_array() && key.is_int()) {
+        TypedArray arr = src.get<TypedArray>();
+        Int idx = key.get<Int>();
+        if (idx < 0 || idx >= static_cast<Int>(arr->size())) {
+            throwVMError("Chỉ số vượt quá phạm vi: '" + std::to_string(idx) + "' trên " + arr->typeName());
+        }
+        if (!arr->set(static_cast<size_t>(idx), val)) {
+            throwVMError(Str(arr->typeName()) + " chỉ chứa số, không thể gán '" + _toString(val) + "'");
+        }
+        return;
+    }
 
 
     if (auto mm = getMagicMethod(src, "__setindex__")) {
@@ -131,40 +171,67 @@ void MeowVM::opSetIndex() {
     }
 
 
-    if (key.is_array()) {
+    if (key.is_int()) {
         Int idx = _toInt(key);
         if (src.is_array()) {
             Array arr = src.get<Array>();
             if (idx < 0) throwVMError("Invalid index");
-            if (idx >= static_cast<Int>(arr->size())) {
+            // Appending keeps a packed array packed; writing past the end leaves null holes
+            if (idx == static_cast<Int>(arr->size())) {
+                arr->push(val);
+                return;
+            }
+            if (idx > static_cast<Int>(arr->size())) {
                 if (idx > 10000000) throwVMError("Index too large");
                 arr->resize(static_cast<size_t>(idx + 1));
             }
-            (*arr)[static_cast<size_t>(idx)] = val;
+            arr->set(static_cast<size_t>(idx), val);
             return;
         }
-        if (src.is_string()) {
+        if (src.is_string() || src.is_rope()) {
+            _flattenRope(val);
             if (!val.is_string() || val.get<Str>().empty()) throwVMError("String assign must be non-empty string");
-            Str &s = src.get<Str>();
-            if (idx < 0 || idx >= static_cast<Int>(s.size())) {
+            // Replace the whole character with the first character of the assigned string. Copied out
+            // first: `val` may be this very register, which promoting below moves into a rope
+            const Str& assigned = val.get<Str>();
+            Str replacement(Utf8Index(assigned).charAt(assigned, 0));
+
+            // Ropes are immutable and may be shared, so a write to a long string builds a new flat rope
+            // from the old one. The character index is built once and then copied and patched
+            _promoteString(src);
+            Utf8Index scratch;
+            const Utf8Index& chars = _utf8Index(src, scratch);
+            if (idx < 0 || idx >= static_cast<Int>(chars.length())) {
                 std::ostringstream os;
                 os << "Chỉ số vượt quá phạm vi: '" << idx << "'. ";
-                os << "Được truy cập trên string: `\n" << _toString(s) << "\n`";
+                os << "Được truy cập trên string: `\n" << _toString(src) << "\n`";
                 throwVMError(os.str());
 
             }
-            s[static_cast<size_t>(idx)] = val.get<Str>()[0];
+            if (src.is_string()) {
+                Str& s = src.get<Str>();
+                size_t begin = chars.byteOffset(s, static_cast<size_t>(idx));
+                size_t end = chars.byteOffset(s, static_cast<size_t>(idx) + 1);
+                s.replace(begin, end - begin, replacement);
+                return;
+            }
+            src = Value(memoryManager->newObject<ObjRope>(src.get<Rope>(), static_cast<size_t>(idx), std::string_view(replacement)));
             return;
         }
         if (src.is_hash()) {
             Object m = src.get<Object>();
-            Str k = _toString(key);
-            m->fields[k] = val;
+            m->fields[key] = val;
             return;
         }
         throwVMError("Numeric index not supported on type '" + _toString(src) + "'");
     }
 
+    if (src.is_hash() && !key.is_string()) {
+        if (!ValueTable::isHashable(key)) throwVMError("SET_INDEX: unhashable key '" + _toString(key) + "'");
+        src.get<Object>()->fields[key] = val;
+        return;
+    }
+
 
     Str keyName = key.is_string() ? key.get<Str>() : _toString(key);
     if (auto mm = getMagicMethod(src, "__setprop__")) {
@@ -175,18 +242,19 @@ void MeowVM::opSetIndex() {
 
     if (src.is_instance()) {
         Instance inst = src.get<Instance>();
-        inst->fields[keyName] = val;
+        inst->setField(keyName, val, *memoryManager);
         return;
     }
     if (src.is_hash()) {
         Object m = src.get<Object>();
-        m->fields[keyName] = val;
+        m->fields[key] = val;
         return;
     }
     if (src.is_class()) {
         Class cls = src.get<Class>();
         if (!val.is_function() && !val.is_bound_method()) throwVMError("Method must be closure");
         cls->methods[keyName] = val;
+        ++classEpoch;
         return;
     }
 
@@ -207,16 +275,16 @@ void MeowVM::opGetKeys() {
 
     if (src.is_instance()) {
         Instance inst = src.get<Instance>();
-        keysArr->reserve(inst->fields.size());
-        for (const auto& pair : inst->fields) {
-            keysArr->push(Value(pair.first));
-        }
+        keysArr->reserve(inst->fieldCount());
+        inst->forEachField([&](const Str& name, const Value&) {
+            keysArr->push(Value(name));
+        });
     } else if (src.is_hash()) {
         Object obj = src.get<Object>();
         keysArr->reserve(obj->fields.size());
-        for (const auto& pair : obj->fields) {
-            keysArr->push(Value(pair.first));
-        }
+        obj->fields.forEach([&](const Value& key, const Value&) {
+            keysArr->push(key);
+        });
     } else if (src.is_array()) {
 
         Array arr = src.get<Array>();
@@ -225,9 +293,9 @@ void MeowVM::opGetKeys() {
         for (Int i = 0; i < size; ++i) {
             keysArr->push(Value(i));
         }
-    } else if (src.is_string()) {
-        Str s = src.get<Str>();
-        Int size = static_cast<Int>(s.length());
+    } else if (src.is_string() || src.is_rope()) {
+        Utf8Index scratch;
+        Int size = static_cast<Int>(_utf8Index(src, scratch).length());
         keysArr->reserve(size);
         for (Int i = 0; i < size; ++i) {
             keysArr->push(Value(i));
@@ -253,32 +321,35 @@ void MeowVM::opGetValues() {
     if (src.is_instance()) {
 
         Instance inst = src.get<Instance>();
-        valueArr->reserve(inst->fields.size());
-        for (const auto& pair : inst->fields) {
-            valueArr->push(pair.second);
-        }
+        valueArr->reserve(inst->fieldCount());
+        inst->forEachField([&](const Str&, const Value& value) {
+            valueArr->push(value);
+        });
     } else if (src.is_hash()) {
 
         Object obj = src.get<Object>();
         valueArr->reserve(obj->fields.size());
-        for (const auto& pair : obj->fields) {
-            valueArr->push(pair.second);
-        }
+        obj->fields.forEach([&](const Value&, const Value& value) {
+            valueArr->push(value);
+        });
     } else if (src.is_array()) {
 
         Array arr = src.get<Array>();
         Int size = static_cast<Int>(arr->size());
         valueArr->reserve(size);
-        for (const auto& element : (*arr)) {
-            valueArr->push(element);
+        for (size_t i = 0; i < arr->size(); ++i) {
+            valueArr->push(arr->get(i));
         }
-    } else if (src.is_string()) {
-
-        Str s = src.get<Str>();
-        Int size = static_cast<Int>(s.length());
-        valueArr->reserve(size);
-        for (const auto& c : s) {
-            valueArr->push(Value(Str(1, c)));
+    } else if (src.is_string() || src.is_rope()) {
+
+        Utf8Index scratch;
+        const Utf8Index& chars = _utf8Index(src, scratch);
+        std::string_view s = _stringView(src);
+        valueArr->reserve(chars.length());
+        for (size_t pos = 0; pos < s.size();) {
+            size_t width = chars.widthAt(s, pos);
+            valueArr->push(width == 1 ? _charValue(s[pos]) : Value(Str(s.substr(pos, width))));
+            pos += width;
         }
     }
     stackSlots[currentBase + dst] = Value(valueArr);
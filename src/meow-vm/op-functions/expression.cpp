@@ -2,6 +2,20 @@
 #include "operator_dispatcher.h"
 #include "common/pch.h"
 
+Value MeowVM::concatStrings(const Value& left, const Value& right) {
+    size_t length = ObjRope::lengthOf(left) + ObjRope::lengthOf(right);
+    if (length >= ObjRope::MIN_LENGTH) {
+        return Value(memoryManager->newObject<ObjRope>(left, right));
+    }
+    Str result;
+    result.reserve(length);
+    for (const Value* side : { &left, &right }) {
+        if (side->is_rope()) side->get<Rope>()->appendTo(result);
+        else result += side->get<Str>();
+    }
+    return Value(std::move(result));
+}
+
 void MeowVM::opBinary() {
     auto proto = currentFrame->closure->proto;
     auto currentInst = &proto->code[(currentFrame->ip) - 1];
@@ -13,6 +27,11 @@ void MeowVM::opBinary() {
     auto& left = stackSlots[currentBase + r1];
     auto& right = stackSlots[currentBase + r2];
 
+    if (currentInst->op == OpCode::ADD && (left.is_string() || left.is_rope()) && (right.is_string() || right.is_rope())) {
+        stackSlots[currentBase + dst] = concatStrings(left, right);
+        return;
+    }
+
     Value result;
     if (auto func = opDispatcher.find(currentInst->op, left, right)) {
         result = (*func)(left, right);
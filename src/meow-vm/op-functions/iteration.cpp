@@ -0,0 +1,108 @@
+#include "meow_vm.h"
+
+// Iterator state lives in three consecutive registers starting at `iter`:
+//   iter     the iterable (or the object returned by __iter__)
+//   iter + 1 cursor into its storage: element/entry/field index, byte offset for strings,
+//            -1 for objects following the __iter__/__next__ protocol
+//   iter + 2 number of items produced so far (the key for arrays, strings and protocol objects)
+// Nothing is materialised up front, so walking a large hash or string allocates nothing.
+
+// ITER_INIT iter src
+void MeowVM::opIterInit() {
+    Int iter = currentInst->args[0], src = currentInst->args[1];
+    if (currentBase + iter + 2 >= static_cast<Int>(stackSlots.size()) ||
+        currentBase + src >= static_cast<Int>(stackSlots.size())) {
+        throwVMError("ITER_INIT register OOB");
+    }
+
+    Value source = stackSlots[currentBase + src];
+    Int cursor = 0;
+    if (source.is_instance()) {
+        // User iterators: __iter__() returns the iterator; an object with only __next__ is its own iterator
+        // __iter__ may also return a builtin iterable, which is then walked like any other
+        if (auto iterFn = getMagicMethod(source, "__iter__")) {
+            source = call(*iterFn, {});
+            if (source.is_instance()) cursor = -1;
+        } else if (getMagicMethod(source, "__next__")) {
+            cursor = -1;
+        }
+    }
+    if (!source.is_instance() && !source.is_array() && !source.is_typed_array() && !source.is_hash() &&
+        !source.is_string() && !source.is_rope() && !source.is_int()) {
+        throwVMError("ITER_INIT: giá trị '" + _toString(source) + "' không thể lặp");
+    }
+
+    stackSlots[currentBase + iter] = source;
+    stackSlots[currentBase + iter + 1] = Value(cursor);
+    stackSlots[currentBase + iter + 2] = Value(Int{0});
+    _promoteString(stackSlots[currentBase + iter]);
+}
+
+// ITER_NEXT keyDst valueDst iter exitTarget  (keyDst/valueDst may be -1)
+void MeowVM::opIterNext() {
+    Int keyDst = currentInst->args[0], valueDst = currentInst->args[1];
+    Int iter = currentInst->args[2], target = currentInst->args[3];
+    if (currentBase + iter + 2 >= static_cast<Int>(stackSlots.size()) ||
+        currentBase + std::max(keyDst, valueDst) >= static_cast<Int>(stackSlots.size())) {
+        throwVMError("ITER_NEXT register OOB");
+    }
+
+    const Value& source = stackSlots[currentBase + iter];
+    Int cursor = stackSlots[currentBase + iter + 1].get<Int>();
+    Int count = stackSlots[currentBase + iter + 2].get<Int>();
+    Value key(count), value;
+    bool done = false;
+
+    if (cursor < 0) {
+        auto nextFn = getMagicMethod(source, "__next__");
+        if (!nextFn) throwVMError("ITER_NEXT: iterator không có phương thức __next__");
+        value = call(*nextFn, {});
+        done = value.is_null();  // __next__ returns null when exhausted
+    } else if (source.is_array()) {
+        Array arr = source.get<Array>();
+        if (!(done = cursor >= static_cast<Int>(arr->size()))) value = arr->get(static_cast<size_t>(cursor++));
+    } else if (source.is_typed_array()) {
+        TypedArray arr = source.get<TypedArray>();
+        if (!(done = cursor >= static_cast<Int>(arr->size()))) value = arr->get(static_cast<size_t>(cursor++));
+    } else if (source.is_int()) {
+        if (!(done = cursor >= source.get<Int>())) value = key = Value(cursor++);
+    } else if (source.is_hash()) {
+        size_t position = static_cast<size_t>(cursor);
+        const Value *k = nullptr, *v = nullptr;
+        if (!(done = !source.get<Object>()->fields.nextEntry(position, k, v))) {
+            key = *k;
+            value = *v;
+        }
+        cursor = static_cast<Int>(position);
+    } else if (source.is_instance()) {
+        size_t position = static_cast<size_t>(cursor);
+        const Str* name = nullptr;
+        const Value* v = nullptr;
+        if (!(done = !source.get<Instance>()->nextField(position, name, v))) {
+            key = Value(*name);
+            value = *v;
+        }
+        cursor = static_cast<Int>(position);
+    } else {
+        // Strings: the cursor is a byte offset, so each step is O(1) whatever the encoding
+        Utf8Index scratch;
+        const Utf8Index& chars = _utf8Index(source, scratch);
+        std::string_view s = _stringView(source);
+        if (!(done = cursor >= static_cast<Int>(s.size()))) {
+            size_t width = chars.widthAt(s, static_cast<size_t>(cursor));
+            value = width == 1 ? _charValue(s[cursor]) : Value(Str(s.substr(static_cast<size_t>(cursor), width)));
+            cursor += static_cast<Int>(width);
+        }
+    }
+
+    if (done) {
+        auto proto = currentFrame->closure->proto;
+        if (target < 0 || target >= static_cast<Int>(proto->code.size())) throwVMError("ITER_NEXT target OOB");
+        currentFrame->ip = target;
+        return;
+    }
+    stackSlots[currentBase + iter + 1] = Value(cursor);
+    stackSlots[currentBase + iter + 2] = Value(count + 1);
+    if (keyDst >= 0) stackSlots[currentBase + keyDst] = key;
+    if (valueDst >= 0) stackSlots[currentBase + valueDst] = value;
+}
@@ -34,14 +34,18 @@ void MeowVM::opLoadFalse() {
 void MeowVM::opGetGlobal() {
     auto proto = currentFrame->closure->proto;
     Int dst = currentInst->args[0], constIdx = currentInst->args[1];
+    Module module = currentFrame->module;
+    if (currentInst->cache >= 0 && proto->linkedModule == module) {
+        stackSlots[currentBase + dst] = module->globalSlots[currentInst->cache];
+        return;
+    }
     if (constIdx < 0 || constIdx >= static_cast<Int>(proto->constantPool.size()))
         throwVMError("GET_GLOBAL index OOB");
     if (!proto->constantPool[constIdx].is_string())
         throwVMError("GET_GLOBAL name must be a string");
     auto name = proto->constantPool[constIdx].get<Str>();
-    auto it = currentFrame->module->globals.find(name);
-    if (it != currentFrame->module->globals.end()) {
-        stackSlots[currentBase + dst] = it->second;
+    if (const Value* global = module->findGlobal(name)) {
+        stackSlots[currentBase + dst] = *global;
     } else {
         stackSlots[currentBase + dst] = Value(Null{});
     }
@@ -50,13 +54,19 @@ void MeowVM::opGetGlobal() {
 void MeowVM::opSetGlobal() {
     auto proto = currentFrame->closure->proto;
     Int constIdx = currentInst->args[0], src = currentInst->args[1];
+    Module module = currentFrame->module;
+    // Code called from another module runs against the caller's globals, so the slot only holds there
+    if (currentInst->cache >= 0 && proto->linkedModule == module) {
+        module->globalSlots[currentInst->cache] = stackSlots[currentBase + src];
+        return;
+    }
     if (constIdx < 0 || constIdx >= static_cast<Int>(proto->constantPool.size())) 
         throwVMError("SET_GLOBAL index OOB với constIdx là: " + _toString(constIdx) + " vuợt quá giới hạn min = 0 và max = " + _toString(static_cast<Int>(proto->constantPool.size() - 1)));
     if (!proto->constantPool[constIdx].is_string()) {
         throwVMError("Global variable name must be a string");
     }
     auto name = proto->constantPool[constIdx].get<Str>();
-    currentFrame->module->globals[name] = stackSlots[currentBase + src];
+    module->setGlobal(name, stackSlots[currentBase + src]);
 }
 
 void MeowVM::opGetUpvalue() {
@@ -23,7 +23,7 @@ void MeowVM::opImportModule() {
 
             auto moduleClosure = memoryManager->newObject<ObjClosure>(mod->mainProto);
             Int newStart = static_cast<Int>(stackSlots.size());
-            stackSlots.resize(newStart + mod->mainProto->numRegisters, Value(Null{}));
+            _growStack(newStart + mod->mainProto->numRegisters);
 
             CallFrame newFrame(moduleClosure, newStart, mod, 0, -1);
             callStack.push_back(newFrame);
@@ -42,7 +42,9 @@ void MeowVM::opExport() {
     if (!(proto->constantPool[nameIdx]).is_string()) 
         throwVMError("EXPORT name must be a string");
     Str exportName = proto->constantPool[nameIdx].get<Str>();
-    currentFrame->module->exports[exportName] = stackSlots[currentBase + srcReg];
+    // meow-link appends the name's export number, so importers can read the export without the name
+    Int slot = currentInst->args.size() > 2 && currentInst->args[2] < linkedExportCount ? currentInst->args[2] : -1;
+    currentFrame->module->setExport(exportName, stackSlots[currentBase + srcReg], slot);
 }
 
 void MeowVM::opGetExport() {
@@ -55,6 +57,12 @@ void MeowVM::opGetExport() {
     Value& moduleVal = stackSlots[currentBase + moduleReg];
     if (!moduleVal.is_module()) 
         throwVMError("Chỉ có thể lấy export từ một đối tượng module: " + _toString(moduleVal));
+    if (currentInst->args.size() > 3) {
+        if (const Value* exported = moduleVal.get<Module>()->findExport(currentInst->args[3])) {
+            stackSlots[currentBase + dst] = *exported;
+            return;
+        }
+    }
     if (nameIdx < 0 || nameIdx >= static_cast<Int>(proto->constantPool.size())) 
         throwVMError("GET_EXPORT index OOB");
     if (!(proto->constantPool[nameIdx]).is_string()) 
@@ -79,6 +87,12 @@ void MeowVM::opGetModuleExport() {
     Value& moduleVal = stackSlots[currentBase + moduleReg];
     if (!moduleVal.is_module())
         throwVMError("GET_MODULE_EXPORT chỉ dùng với module.");
+    if (currentInst->args.size() > 3) {
+        if (const Value* exported = moduleVal.get<Module>()->findExport(currentInst->args[3])) {
+            stackSlots[currentBase + dst] = *exported;
+            return;
+        }
+    }
 
     if (nameIdx < 0 || nameIdx >= static_cast<Int>(proto->constantPool.size()) || !(proto->constantPool[nameIdx]).is_string())
         throwVMError("Export name phải là string hợp lệ");
@@ -109,6 +123,6 @@ void MeowVM::opImportAll() {
     auto currentModule = currentFrame->module;
 
     for (const auto& pair : importedModule->exports) {
-        currentModule->globals[pair.first] = pair.second;
+        currentModule->setGlobal(pair.first, pair.second);
     }
 }
\ No newline at end of file
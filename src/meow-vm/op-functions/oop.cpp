@@ -30,16 +30,54 @@ void MeowVM::opGetProp() {
     if (nameIdx < 0 || nameIdx >= static_cast<Int>(proto->constantPool.size()) || !(proto->constantPool[nameIdx]).is_string())
         throwVMError("Property name must be a string");
 
-    Str name = proto->constantPool[nameIdx].get<Str>();
+    const Str& name = proto->constantPool[nameIdx].get<Str>();
     Value& obj = stackSlots[currentBase + objReg];
 
     if (obj.is_instance()) {
         Instance inst = obj.get<Instance>();
-        auto it = inst->fields.find(name);
-        if (it != inst->fields.end()) {
-            stackSlots[currentBase + dst] = it->second;
+        PropertyCache* cache = (currentInst->cache >= 0) ? &proto->propertyCaches[currentInst->cache] : nullptr;
+
+        if (cache && inst->shape) {
+            if (auto entry = cache->find(inst->shape)) {
+                if (entry->slot >= 0) {
+                    ++icStats.hits;
+                    stackSlots[currentBase + dst] = inst->slotAt(entry->slot);
+                    return;
+                }
+                if (entry->epoch == classEpoch) {
+                    ++icStats.hits;
+                    stackSlots[currentBase + dst] = bindMethod(inst, entry->method);
+                    return;
+                }
+            }
+        }
+        ++icStats.misses;
+
+        if (Value* field = inst->getField(name)) {
+            if (cache && inst->shape) cache->add({ inst->shape, inst->shape->lookup(name), nullptr, Value(), 0 });
+            stackSlots[currentBase + dst] = *field;
             return;
         }
+        if (auto method = findClassMethod(inst->klass, name)) {
+            if (cache && inst->shape) cache->add({ inst->shape, -1, nullptr, *method, classEpoch });
+            stackSlots[currentBase + dst] = bindMethod(inst, *method);
+            return;
+        }
+    }
+
+    // `GET_PROP f obj name; CALL r f ...` on a builtin method calls the native with `obj` as its receiver
+    // and never builds the binding, as long as nothing reads `f` after the call
+    if (!obj.is_instance() && currentFrame->ip < static_cast<Int>(proto->code.size())) {
+        const Instruction& next = proto->code[currentFrame->ip];
+        if (next.op == OpCode::CALL && next.args.size() >= 4 && next.args[1] == dst &&
+            (dst < next.args[2] || dst >= next.args[2] + next.args[3]) &&
+            (next.args[0] == dst || (next.firstDead >= 0 && dst >= next.firstDead))) {
+            if (const Value* method = _findBuiltinMethod(obj, name)) {
+                ++currentFrame->ip;
+                _finishNativeCall(method->get<NativeFn>(), &obj, next.args[0], next.args[2], next.args[3], currentBase);
+                return;
+            }
+        }
     }
 
     if (auto prop = getMagicMethod(obj, name)) {
@@ -61,7 +99,7 @@ void MeowVM::opSetProp() {
     if (nameIdx < 0 || nameIdx >= static_cast<Int>(proto->constantPool.size()) || !(proto->constantPool[nameIdx]).is_string())
         throwVMError("Property name must be a string");
 
-    Str name = proto->constantPool[nameIdx].get<Str>();
+    const Str& name = proto->constantPool[nameIdx].get<Str>();
     Value& obj = stackSlots[currentBase + objReg];
     Value& val = stackSlots[currentBase + valReg];
 
@@ -73,18 +111,36 @@ void MeowVM::opSetProp() {
 
     if (obj.is_instance()) {
         Instance inst = obj.get<Instance>();
-        inst->fields[name] = val;
+        PropertyCache* cache = (currentInst->cache >= 0) ? &proto->propertyCaches[currentInst->cache] : nullptr;
+
+        if (cache && inst->shape) {
+            if (auto entry = cache->find(inst->shape)) {
+                ++icStats.hits;
+                if (entry->transition) inst->appendSlot(entry->transition, val);
+                else inst->slotAt(entry->slot) = val;
+                return;
+            }
+        }
+        ++icStats.misses;
+
+        Shape before = inst->shape;
+        inst->setField(name, val, *memoryManager);
+        if (cache && before && inst->shape) {
+            if (inst->shape == before) cache->add({ before, before->lookup(name), nullptr, Value(), 0 });
+            else cache->add({ before, inst->shape->slotCount - 1, inst->shape, Value(), 0 });
+        }
         return;
     }
     if (obj.is_hash()) {
         Object m = obj.get<Object>();
-        m->fields[name] = val;
+        m->fields[Value(name)] = val;
         return;
     }
     if (obj.is_class()) {
         Class cls = obj.get<Class>();
         if (!val.is_function() && !val.is_bound_method()) throwVMError("Method must be closure");
         cls->methods[name] = val;
+        ++classEpoch;
         return;
     }
 
@@ -106,6 +162,7 @@ void MeowVM::opSetMethod() {
     if(!stackSlots[currentBase + methodReg].is_class()) 
         throwVMError("Method value must be a closure");
     klassVal.get<Class>()->methods[name] = stackSlots[currentBase + methodReg];
+    ++classEpoch;
 }
 
 void MeowVM::opInherit() {
@@ -113,14 +170,9 @@ void MeowVM::opInherit() {
     Value& subClassVal = stackSlots[currentBase + subClassReg];
     Value& superClassVal = stackSlots[currentBase + superClassReg];
     if(!subClassVal.is_class() || !superClassVal.is_class()) throwVMError("Cả hai toán hạng cho kế thừa phải là class.");
+    // Methods are resolved through the chain on lookup, so later additions to the superclass stay visible
     subClassVal.get<Class>()->superclass = superClassVal.get<Class>();
-    auto& subMethods = subClassVal.get<Class>()->methods;
-    auto& superMethods = superClassVal.get<Class>()->methods;
-    for(const auto& pair : superMethods) {
-        if(subMethods.find(pair.first) == subMethods.end()) {
-            subMethods[pair.first] = pair.second;
-        }
-    }
+    ++classEpoch;
 }
 
 void MeowVM::opGetSuper() {
@@ -144,11 +196,11 @@ void MeowVM::opGetSuper() {
     }
     Class superclass = *receiver->klass->superclass;
 
-    auto it = superclass->methods.find(methodName);
-    if (it == superclass->methods.end()) {
+    auto found = findClassMethod(superclass, methodName);
+    if (!found) {
         throwVMError("Superclass '" + superclass->name + "' has no method named '" + methodName + "'.");
     }
-    Value& method = it->second;
+    Value method = *found;
     if (!method.is_function()) {
         throwVMError("Superclass method is not a callable closure.");
     }
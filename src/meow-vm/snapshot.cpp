@@ -0,0 +1,952 @@
+#include <unordered_set>
+
+#include "meow_vm.h"
+#include "mapped_file.h"
+
+/*
+ * Snapshot layout: header, native library paths, string table, native keys, object table (kind and
+ * constructor data of every object), VM roots, then one payload per object in table order.
+ * Objects refer to each other by table index, so loading allocates everything first and fills it in after.
+ * Native functions cannot be written out; they are named by where they were registered and looked
+ * up again in the loading VM, which is why --snapshot-create tags every native as it is registered.
+ */
+
+// Types that SnapshotWriter and SnapshotReader hold as members. The two classes have external linkage (MeowVM
+// befriends them), so these cannot live in the anonymous namespace below
+namespace snapshot_detail {
+    enum class SnapshotKind : Uint8 {
+        PROTO, MODULE, UPVALUE, CLOSURE, SHAPE, CLASS, INSTANCE, BOUND_METHOD, ARRAY, TYPED_ARRAY, ROPE, OBJECT
+    };
+
+    enum class SnapshotTag : Uint8 { NUL, INT, REAL, BOOL, STRING, OBJECT, NATIVE, BOUND_NATIVE };
+
+    class SnapshotSink {
+    public:
+        std::vector<char> bytes;
+        template <typename T>
+        void put(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const char* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(T));
+        }
+    };
+
+    class SnapshotSource {
+    public:
+        explicit SnapshotSource(std::string_view bytes = {}) : bytes(bytes) {}
+        template <typename T>
+        T get() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (sizeof(T) > bytes.size() - pos) throw VMError("Snapshot bị cắt cụt hoặc hỏng");
+            T value;
+            std::memcpy(&value, bytes.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+        /// @brief A count of entries that each take at least one more byte, so a corrupt count cannot ask for more than the file holds
+        template <typename T>
+        size_t count() {
+            T n = get<T>();
+            if (n > bytes.size() - pos) throw VMError("Snapshot bị cắt cụt hoặc hỏng");
+            return static_cast<size_t>(n);
+        }
+        std::string_view take(size_t size) {
+            if (size > bytes.size() - pos) throw VMError("Snapshot bị cắt cụt hoặc hỏng");
+            std::string_view out = bytes.substr(pos, size);
+            pos += size;
+            return out;
+        }
+        [[nodiscard]] bool atEnd() const noexcept { return pos == bytes.size(); }
+    private:
+        std::string_view bytes;
+        size_t pos = 0;
+    };
+}
+
+namespace {
+    using snapshot_detail::SnapshotKind;
+    using snapshot_detail::SnapshotTag;
+    using snapshot_detail::SnapshotSink;
+    using snapshot_detail::SnapshotSource;
+
+    constexpr char SNAPSHOT_MAGIC[8] = { 'M', 'E', 'O', 'W', 'S', 'N', 'A', 'P' };
+    constexpr Uint32 SNAPSHOT_VERSION = 5;
+    constexpr Uint32 SNAPSHOT_NO_OBJECT = 0xFFFFFFFFu;
+    constexpr Uint32 SNAPSHOT_BUILTINS = 0xFFFFFFFEu;  // the shared builtin scope, which every VM builds itself
+
+    constexpr SnapshotKind kindOf(const ObjFunctionProto*) noexcept { return SnapshotKind::PROTO; }
+    constexpr SnapshotKind kindOf(const ObjModule*) noexcept { return SnapshotKind::MODULE; }
+    constexpr SnapshotKind kindOf(const ObjUpvalue*) noexcept { return SnapshotKind::UPVALUE; }
+    constexpr SnapshotKind kindOf(const ObjClosure*) noexcept { return SnapshotKind::CLOSURE; }
+    constexpr SnapshotKind kindOf(const ObjShape*) noexcept { return SnapshotKind::SHAPE; }
+    constexpr SnapshotKind kindOf(const ObjClass*) noexcept { return SnapshotKind::CLASS; }
+    constexpr SnapshotKind kindOf(const ObjInstance*) noexcept { return SnapshotKind::INSTANCE; }
+    constexpr SnapshotKind kindOf(const ObjBoundMethod*) noexcept { return SnapshotKind::BOUND_METHOD; }
+    constexpr SnapshotKind kindOf(const ObjArray*) noexcept { return SnapshotKind::ARRAY; }
+    constexpr SnapshotKind kindOf(const ObjTypedArray*) noexcept { return SnapshotKind::TYPED_ARRAY; }
+    constexpr SnapshotKind kindOf(const ObjRope*) noexcept { return SnapshotKind::ROPE; }
+    constexpr SnapshotKind kindOf(const ObjObject*) noexcept { return SnapshotKind::OBJECT; }
+
+    /// @brief Native callable that remembers where it was registered, so that a snapshot can name it
+    template <typename Fn>
+    struct SnapshotNative {
+        Fn fn;
+        Str key;
+        template <typename... Args>
+        Value operator()(Args&&... args) const { return fn(std::forward<Args>(args)...); }
+    };
+
+    Value tagNative(const Value& value, const Str& key) {
+        const NativeFn* native = value.get_if<NativeFn>();
+        if (!native) return value;
+        return std::visit([&](const auto& fn) -> Value {
+            using Fn = std::decay_t<decltype(fn)>;
+            // Bindings are made at run time from natives that are already tagged
+            if constexpr (std::is_same_v<Fn, BoundNative>) {
+                return value;
+            } else {
+                if (fn.template target<SnapshotNative<Fn>>()) return value;
+                return Value(NativeFn(Fn(SnapshotNative<Fn>{ fn, key })));
+            }
+        }, *native);
+    }
+
+    const Str* nativeKey(const NativeFn& native) noexcept {
+        return std::visit([](const auto& fn) -> const Str* {
+            using Fn = std::decay_t<decltype(fn)>;
+            if constexpr (std::is_same_v<Fn, BoundNative>) {
+                return nullptr;
+            } else {
+                auto tagged = fn.template target<SnapshotNative<Fn>>();
+                return tagged ? &tagged->key : nullptr;
+            }
+        }, native);
+    }
+
+    // Keys of every place a native can be registered
+    Str builtinKey(const Str& name) { return "builtin:" + name; }
+    Str methodKey(const Str& type, const Str& name) { return "method:" + type + ":" + name; }
+    Str getterKey(const Str& type, const Str& name) { return "getter:" + type + ":" + name; }
+    Str libraryKey(const Str& libPath, const char* where, const Str& name) { return "lib:" + libPath + ":" + where + ":" + name; }
+
+    /// @brief Walks everything the VM reaches, the way the collector marks it, and gathers the protos whose body is not loaded yet
+    class LazyBodyFinder : public GCVisitor {
+    public:
+        std::vector<Proto> unloaded;
+
+        void visit_value(const Value& v) noexcept override {
+            if (auto p = v.get_if<Array>()) visit_object(*p);
+            else if (auto p = v.get_if<Object>()) visit_object(*p);
+            else if (auto p = v.get_if<Instance>()) visit_object(*p);
+            else if (auto p = v.get_if<Class>()) visit_object(*p);
+            else if (auto p = v.get_if<Upvalue>()) visit_object(*p);
+            else if (auto p = v.get_if<Function>()) visit_object(*p);
+            else if (auto p = v.get_if<Module>()) visit_object(*p);
+            else if (auto p = v.get_if<BoundMethod>()) visit_object(*p);
+            else if (auto p = v.get_if<Proto>()) visit_object(*p);
+            else if (auto p = v.get_if<TypedArray>()) visit_object(*p);
+            else if (auto p = v.get_if<Rope>()) visit_object(*p);
+            else if (auto native = v.get_if<NativeFn>()) {
+                if (auto bound = std::get_if<BoundNative>(native)) visit_value((*bound)->receiver);
+            }
+        }
+
+        void visit_object(const MeowObject* object) noexcept override {
+            if (!object || !seen.insert(object).second) return;
+            gray.push_back(object);
+            auto proto = dynamic_cast<const ObjFunctionProto*>(object);
+            if (proto && !proto->isLoaded()) unloaded.push_back(const_cast<Proto>(proto));
+        }
+
+        /// @brief Traces every object reached so far; a proto whose body was loaded since can be handed back to `retrace`
+        void drain() noexcept {
+            while (!gray.empty()) {
+                const MeowObject* object = gray.back();
+                gray.pop_back();
+                object->trace(*this);
+            }
+        }
+
+        void retrace(Proto proto) {
+            gray.push_back(proto);
+        }
+    private:
+        std::unordered_set<const MeowObject*> seen;
+        std::vector<const MeowObject*> gray;
+    };
+}
+
+// --- Writing ---
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(MeowVM& vm) : vm(vm) {}
+
+    void write(const Str& path) {
+        loadLazyBodies();
+
+        // Roots first: they number the objects they reach, and every object then numbers its own references
+        roots.put(static_cast<Uint32>(vm.moduleCache.size()));
+        for (const auto& [key, module] : vm.moduleCache) {
+            roots.put(string(key));
+            ref(roots, module);
+        }
+        roots.put(static_cast<Uint32>(vm.callStack.size()));
+        for (const CallFrame& frame : vm.callStack) {
+            ref(roots, frame.closure);
+            ref(roots, frame.module);
+            roots.put(frame.slotStart);
+            roots.put(frame.ip);
+            roots.put(frame.retReg);
+        }
+        roots.put(static_cast<Uint64>(vm.stackSlots.size()));
+        for (const Value& slot : vm.stackSlots) value(roots, slot);
+        roots.put(static_cast<Uint32>(vm.openUpvalues.size()));
+        for (Upvalue upvalue : vm.openUpvalues) ref(roots, upvalue);
+        roots.put(static_cast<Uint32>(vm.exceptionHandlers.size()));
+        for (const ExceptionHandler& handler : vm.exceptionHandlers) {
+            roots.put(handler.catchIp);
+            roots.put(handler.frameDepth);
+            roots.put(handler.stackDepth);
+        }
+        roots.put(vm.classEpoch);
+        roots.put(vm.linkedExportCount);
+
+        for (size_t i = 0; i < objects.size(); ++i) payload(objects[i].first, objects[i].second);
+
+        SnapshotSink out;
+        out.bytes.insert(out.bytes.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+        out.put(SNAPSHOT_VERSION);
+        out.put(static_cast<Uint32>(vm.nativeLibraries.size()));
+        for (const Str& library : vm.nativeLibraries) putString(out, library);
+        out.put(static_cast<Uint32>(strings.size()));
+        for (const Str& s : strings) putString(out, s);
+        out.put(static_cast<Uint32>(natives.size()));
+        for (const Str& key : natives) putString(out, key);
+        out.put(static_cast<Uint32>(objects.size()));
+        for (const auto& [object, kind] : objects) constructor(out, object, kind);
+        out.bytes.insert(out.bytes.end(), roots.bytes.begin(), roots.bytes.end());
+        out.bytes.insert(out.bytes.end(), payloads.bytes.begin(), payloads.bytes.end());
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.bytes.data(), static_cast<std::streamsize>(out.bytes.size()))) {
+            throw VMError("Không thể ghi snapshot: " + path);
+        }
+    }
+private:
+    MeowVM& vm;
+    SnapshotSink roots;
+    SnapshotSink payloads;
+    std::vector<Str> strings;
+    std::unordered_map<Str, Uint32> stringIndex;
+    std::vector<Str> natives;
+    std::unordered_map<Str, Uint32> nativeIndex;
+    std::vector<std::pair<MeowObject*, SnapshotKind>> objects;
+    std::unordered_map<const MeowObject*, Uint32> ids;
+
+    /// @brief Loading a body links its globals into its module, so every body is loaded before any module is written
+    void loadLazyBodies() {
+        LazyBodyFinder finder;
+        vm.traceRoots(finder);
+        finder.drain();
+        while (!finder.unloaded.empty()) {
+            Proto proto = finder.unloaded.back();
+            finder.unloaded.pop_back();
+            Str error;
+            if (!proto->loadBody(error)) throw VMError("Không thể nạp thân hàm '" + proto->sourceName + "': " + error);
+            // Its constants and the functions they name are only reachable now
+            finder.retrace(proto);
+            finder.drain();
+        }
+    }
+
+    static void putString(SnapshotSink& out, const Str& s) {
+        out.put(static_cast<Uint32>(s.size()));
+        out.bytes.insert(out.bytes.end(), s.begin(), s.end());
+    }
+
+    Uint32 string(const Str& s) {
+        auto [it, inserted] = stringIndex.try_emplace(s, static_cast<Uint32>(strings.size()));
+        if (inserted) strings.push_back(s);
+        return it->second;
+    }
+
+    template <typename T>
+    void ref(SnapshotSink& out, T* object) {
+        if (!object) {
+            out.put(SNAPSHOT_NO_OBJECT);
+            return;
+        }
+        if constexpr (std::is_same_v<T, ObjModule>) {
+            if (object == vm.builtinScope) {
+                out.put(SNAPSHOT_BUILTINS);
+                return;
+            }
+        }
+        auto [it, inserted] = ids.try_emplace(object, static_cast<Uint32>(objects.size()));
+        if (inserted) objects.emplace_back(object, kindOf(object));
+        out.put(it->second);
+    }
+
+    void value(SnapshotSink& out, const Value& v) {
+        if (v.is_null()) {
+            out.put(SnapshotTag::NUL);
+        } else if (auto i = v.get_if<Int>()) {
+            out.put(SnapshotTag::INT);
+            out.put(*i);
+        } else if (auto r = v.get_if<Real>()) {
+            out.put(SnapshotTag::REAL);
+            out.put(*r);
+        } else if (auto b = v.get_if<Bool>()) {
+            out.put(SnapshotTag::BOOL);
+            out.put(static_cast<Uint8>(*b));
+        } else if (auto s = v.get_if<Str>()) {
+            out.put(SnapshotTag::STRING);
+            out.put(string(*s));
+        } else if (auto native = v.get_if<NativeFn>()) {
+            if (auto bound = std::get_if<BoundNative>(native)) {
+                out.put(SnapshotTag::BOUND_NATIVE);
+                out.put(nativeId((*bound)->function));
+                value(out, (*bound)->receiver);
+            } else {
+                out.put(SnapshotTag::NATIVE);
+                out.put(nativeId(*native));
+            }
+        } else {
+            out.put(SnapshotTag::OBJECT);
+            if (auto p = v.get_if<Array>()) ref(out, *p);
+            else if (auto p = v.get_if<Object>()) ref(out, *p);
+            else if (auto p = v.get_if<Instance>()) ref(out, *p);
+            else if (auto p = v.get_if<Class>()) ref(out, *p);
+            else if (auto p = v.get_if<Upvalue>()) ref(out, *p);
+            else if (auto p = v.get_if<Function>()) ref(out, *p);
+            else if (auto p = v.get_if<Module>()) ref(out, *p);
+            else if (auto p = v.get_if<BoundMethod>()) ref(out, *p);
+            else if (auto p = v.get_if<Proto>()) ref(out, *p);
+            else if (auto p = v.get_if<TypedArray>()) ref(out, *p);
+            else if (auto p = v.get_if<Rope>()) ref(out, *p);
+        }
+    }
+
+    Uint32 nativeId(const NativeFn& native) {
+        const Str* key = nativeKey(native);
+        if (!key) throw VMError("Snapshot không thể lưu một hàm native được tạo lúc chạy");
+        auto [it, inserted] = nativeIndex.try_emplace(*key, static_cast<Uint32>(natives.size()));
+        if (inserted) natives.push_back(*key);
+        return it->second;
+    }
+
+    void constructor(SnapshotSink& out, MeowObject* object, SnapshotKind kind) {
+        out.put(kind);
+        if (kind == SnapshotKind::TYPED_ARRAY) {
+            auto array = static_cast<TypedArray>(object);
+            out.put(array->kind());
+            out.put(static_cast<Uint64>(array->size()));
+        } else if (kind == SnapshotKind::ROPE) {
+            Str flat;
+            static_cast<Rope>(object)->appendTo(flat);
+            putString(out, flat);
+        }
+    }
+
+    void payload(MeowObject* object, SnapshotKind kind) {
+        SnapshotSink& out = payloads;
+        switch (kind) {
+            case SnapshotKind::PROTO: {
+                auto proto = static_cast<Proto>(object);
+                out.put(proto->numRegisters);
+                out.put(proto->numUpvalues);
+                out.put(string(proto->sourceName));
+                out.put(static_cast<Uint32>(proto->code.size()));
+                for (const Instruction& inst : proto->code) {
+                    out.put(inst.op);
+                    out.put(inst.cache);
+                    out.put(inst.firstDead);
+                    out.put(static_cast<Uint32>(inst.args.size()));
+                    for (Int arg : inst.args) out.put(arg);
+                }
+                out.put(static_cast<Uint32>(proto->constantPool.size()));
+                for (const Value& constant : proto->constantPool) value(out, constant);
+                out.put(static_cast<Uint32>(proto->upvalueDescs.size()));
+                for (const UpvalueDesc& desc : proto->upvalueDescs) {
+                    out.put(static_cast<Uint8>(desc.isLocal));
+                    out.put(desc.index);
+                }
+                out.put(static_cast<Uint32>(proto->propertyCaches.size()));
+                ref(out, proto->linkedModule);
+                break;
+            }
+            case SnapshotKind::MODULE: {
+                auto module = static_cast<Module>(object);
+                out.put(string(module->name));
+                out.put(string(module->path));
+                out.put(static_cast<Uint32>(module->globalSlots.size()));
+                for (const Value& slot : module->globalSlots) value(out, slot);
+                out.put(static_cast<Uint32>(module->globalIndex.size()));
+                for (const auto& [name, slot] : module->globalIndex) {
+                    out.put(string(name));
+                    out.put(slot);
+                }
+                ref(out, module->builtins);
+                out.put(static_cast<Uint32>(module->exports.size()));
+                for (const auto& [name, exported] : module->exports) {
+                    out.put(string(name));
+                    value(out, exported);
+                }
+                out.put(static_cast<Uint32>(module->exportSlots.size()));
+                for (const auto* entry : module->exportSlots) {
+                    out.put(static_cast<Uint8>(entry != nullptr));
+                    if (entry) out.put(string(entry->first));
+                }
+                ref(out, module->hasMain ? module->mainProto : nullptr);
+                out.put(static_cast<Uint8>(module->isExecuted | module->isBinary << 1 | module->hasMain << 2 | module->isExecuting << 3));
+                break;
+            }
+            case SnapshotKind::UPVALUE: {
+                auto upvalue = static_cast<Upvalue>(object);
+                out.put(static_cast<Uint8>(upvalue->state == ObjUpvalue::State::CLOSED));
+                out.put(upvalue->slotIndex);
+                value(out, upvalue->closed);
+                break;
+            }
+            case SnapshotKind::CLOSURE: {
+                auto closure = static_cast<Function>(object);
+                ref(out, closure->proto);
+                out.put(static_cast<Uint32>(closure->upvalues.size()));
+                for (Upvalue upvalue : closure->upvalues) ref(out, upvalue);
+                break;
+            }
+            case SnapshotKind::SHAPE: {
+                auto shape = static_cast<Shape>(object);
+                ref(out, shape->parent);
+                out.put(string(shape->name));
+                out.put(shape->slotCount);
+                out.put(static_cast<Uint32>(shape->transitions.size()));
+                for (const auto& [name, next] : shape->transitions) {
+                    out.put(string(name));
+                    ref(out, next);
+                }
+                break;
+            }
+            case SnapshotKind::CLASS: {
+                auto klass = static_cast<Class>(object);
+                out.put(string(klass->name));
+                ref(out, klass->superclass ? *klass->superclass : nullptr);
+                out.put(static_cast<Uint8>(klass->superclass.has_value()));
+                out.put(static_cast<Uint32>(klass->methods.size()));
+                for (const auto& [name, method] : klass->methods) {
+                    out.put(string(name));
+                    value(out, method);
+                }
+                ref(out, klass->instanceShape);
+                break;
+            }
+            case SnapshotKind::INSTANCE: {
+                auto instance = static_cast<Instance>(object);
+                ref(out, instance->klass);
+                ref(out, instance->shape);
+                Int used = instance->shape ? std::min(instance->shape->slotCount, ObjInstance::INLINE_SLOTS) : 0;
+                out.put(static_cast<Uint32>(used));
+                for (Int i = 0; i < used; ++i) value(out, instance->inlineSlots[i]);
+                out.put(static_cast<Uint32>(instance->extraSlots.size()));
+                for (const Value& slot : instance->extraSlots) value(out, slot);
+                out.put(static_cast<Uint8>(instance->isDictionary()));
+                if (instance->dictionary) table(out, *instance->dictionary);
+                break;
+            }
+            case SnapshotKind::BOUND_METHOD: {
+                auto bound = static_cast<BoundMethod>(object);
+                ref(out, bound->receiver);
+                ref(out, bound->callable);
+                break;
+            }
+            case SnapshotKind::ARRAY: {
+                auto array = static_cast<Array>(object);
+                out.put(array->kind());
+                out.put(static_cast<Uint64>(array->size()));
+                for (size_t i = 0; i < array->size(); ++i) value(out, array->get(i));
+                break;
+            }
+            case SnapshotKind::TYPED_ARRAY: {
+                auto array = static_cast<TypedArray>(object);
+                const char* raw = array->isFloat() ? reinterpret_cast<const char*>(array->reals()) : reinterpret_cast<const char*>(array->ints());
+                out.bytes.insert(out.bytes.end(), raw, raw + array->size() * 8);
+                break;
+            }
+            case SnapshotKind::ROPE:
+                break;
+            case SnapshotKind::OBJECT:
+                table(out, static_cast<Object>(object)->fields);
+                break;
+        }
+    }
+
+    void table(SnapshotSink& out, const ValueTable& entries) {
+        out.put(static_cast<Uint64>(entries.size()));
+        entries.forEach([&](const Value& key, const Value& entry) {
+            value(out, key);
+            value(out, entry);
+        });
+    }
+};
+
+// --- Reading ---
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(MeowVM& vm) : vm(vm) {}
+
+    void read(const Str& path) {
+        MappedFile file;
+        if (!file.open(path)) throw VMError("Không thể mở snapshot: " + path);
+        in = SnapshotSource(file.view());
+        if (in.take(sizeof(SNAPSHOT_MAGIC)) != std::string_view(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))) {
+            throw VMError("'" + path + "' không phải là snapshot");
+        }
+        if (Uint32 version = in.get<Uint32>(); version != SNAPSHOT_VERSION) {
+            throw VMError("Phiên bản snapshot " + std::to_string(version) + " không được hỗ trợ (cần " + std::to_string(SNAPSHOT_VERSION) + ")");
+        }
+
+        // Natives of this VM by key, including those of the native libraries the snapshot used
+        std::unordered_map<Str, Value> available;
+        vm.builtinScope->forEachGlobal([&](const Str& name, const Value& v) { available.emplace(builtinKey(name), v); });
+        for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+            Str library(takeString());
+            Module module = vm._loadNativeLibrary(library);
+            vm.nativeLibraries.push_back(library);
+            module->forEachGlobal([&](const Str& name, const Value& v) { available.emplace(libraryKey(library, "global", name), v); });
+            for (const auto& [name, v] : module->exports) available.emplace(libraryKey(library, "export", name), v);
+        }
+        for (const auto& [type, methods] : vm.builtinMethods) {
+            for (const auto& [name, v] : methods) available.emplace(methodKey(type, name), v);
+        }
+        for (const auto& [type, getters] : vm.builtinGetters) {
+            for (const auto& [name, v] : getters) available.emplace(getterKey(type, name), v);
+        }
+
+        strings.resize(in.count<Uint32>());
+        for (Str& s : strings) s = Str(takeString());
+        natives.resize(in.count<Uint32>());
+        for (Value& native : natives) {
+            Str key(takeString());
+            auto it = available.find(key);
+            if (it == available.end()) throw VMError("Snapshot cần hàm native '" + key + "' mà VM này không có");
+            native = it->second;
+        }
+
+        objects.resize(in.count<Uint32>());
+        for (auto& [object, kind] : objects) {
+            kind = in.get<SnapshotKind>();
+            object = allocate(kind);
+        }
+
+        vm.moduleCache.clear();
+        for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+            Str key = string();
+            vm.moduleCache[key] = ref<ObjModule>();
+        }
+        vm.moduleCache["native"] = vm.builtinScope;
+        vm.callStack.clear();
+        for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+            Function closure = ref<ObjClosure>();
+            Module module = ref<ObjModule>();
+            Int slotStart = in.get<Int>();
+            Int ip = in.get<Int>();
+            Int retReg = in.get<Int>();
+            if (!closure) throw VMError("Snapshot hỏng: khung gọi không có closure");
+            vm.callStack.emplace_back(closure, slotStart, module, ip, retReg);
+        }
+        size_t slotCount = in.count<Uint64>();
+        if (slotCount > static_cast<size_t>(vm.stackLimit)) throw VMError("Snapshot cần ngăn xếp " + std::to_string(slotCount) + " thanh ghi, vượt quá giới hạn " + std::to_string(vm.stackLimit));
+        vm._growStack(static_cast<Int>(slotCount));
+        for (Value& slot : vm.stackSlots) slot = value();
+        vm.openUpvalues.resize(in.count<Uint32>());
+        for (Upvalue& upvalue : vm.openUpvalues) upvalue = ref<ObjUpvalue>();
+        vm.exceptionHandlers.clear();
+        for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+            Int catchIp = in.get<Int>();
+            Int frameDepth = in.get<Int>();
+            Int stackDepth = in.get<Int>();
+            vm.exceptionHandlers.emplace_back(catchIp, frameDepth, stackDepth);
+        }
+        vm.classEpoch = in.get<Uint64>();
+        // Each number names an export, whose name is one of the snapshot's strings
+        vm.linkedExportCount = in.get<Int>();
+        if (vm.linkedExportCount < 0 || vm.linkedExportCount > static_cast<Int>(strings.size())) throw VMError("Snapshot hỏng: số export liên kết không hợp lệ");
+
+        for (auto& [object, kind] : objects) payload(object, kind);
+        if (!in.atEnd()) throw VMError("Snapshot hỏng: thừa dữ liệu ở cuối file");
+
+        // Shape segments are rebuilt from the chain rather than stored; a well-formed chain also cannot loop
+        for (auto& [object, kind] : objects) {
+            if (kind != SnapshotKind::SHAPE) continue;
+            auto shape = static_cast<Shape>(object);
+            if (shape->parent ? shape->slotCount != shape->parent->slotCount + 1 : shape->slotCount != 0) {
+                throw VMError("Snapshot hỏng: chuỗi shape không hợp lệ");
+            }
+        }
+        for (auto& [object, kind] : objects) {
+            if (kind == SnapshotKind::SHAPE) static_cast<Shape>(object)->buildSegment();
+        }
+
+        // Instruction caches and call windows index property caches, global slots and registers without further checks
+        for (auto& [object, kind] : objects) {
+            if (kind != SnapshotKind::PROTO) continue;
+            auto proto = static_cast<Proto>(object);
+            for (const Instruction& inst : proto->code) {
+                if (inst.firstDead < -1 || inst.firstDead > proto->numRegisters) throw VMError("Snapshot hỏng: cửa sổ gọi hàm nằm ngoài phạm vi");
+                Int limit;
+                switch (inst.op) {
+                    case OpCode::GET_PROP:
+                    case OpCode::SET_PROP:
+                        limit = static_cast<Int>(proto->propertyCaches.size());
+                        break;
+                    case OpCode::GET_GLOBAL:
+                    case OpCode::SET_GLOBAL:
+                        limit = proto->linkedModule ? static_cast<Int>(proto->linkedModule->globalSlots.size()) : 0;
+                        break;
+                    default:
+                        continue;
+                }
+                if (inst.cache < -1 || inst.cache >= limit) throw VMError("Snapshot hỏng: inline cache nằm ngoài phạm vi");
+            }
+        }
+
+        // The interpreter trusts frames and open upvalues to point inside the stack
+        Int stackSize = static_cast<Int>(vm.stackSlots.size());
+        for (const CallFrame& frame : vm.callStack) {
+            Proto proto = frame.closure->proto;
+            if (frame.slotStart < 0 || frame.slotStart + proto->numRegisters > stackSize || frame.ip < 0 || frame.ip > static_cast<Int>(proto->code.size())) {
+                throw VMError("Snapshot hỏng: khung gọi nằm ngoài ngăn xếp");
+            }
+        }
+        for (Upvalue upvalue : vm.openUpvalues) {
+            if (!upvalue || upvalue->state != ObjUpvalue::State::OPEN || upvalue->slotIndex < 0 || upvalue->slotIndex >= stackSize) {
+                throw VMError("Snapshot hỏng: upvalue mở nằm ngoài ngăn xếp");
+            }
+        }
+    }
+private:
+    MeowVM& vm;
+    SnapshotSource in;
+    std::vector<Str> strings;
+    std::vector<Value> natives;
+    std::vector<std::pair<MeowObject*, SnapshotKind>> objects;
+    Bool readingReceiver = false;
+
+    std::string_view takeString() { return in.take(in.get<Uint32>()); }
+
+    const Str& string() {
+        Uint32 index = in.get<Uint32>();
+        if (index >= strings.size()) throw VMError("Snapshot hỏng: chỉ số chuỗi không hợp lệ");
+        return strings[index];
+    }
+
+    MeowObject* allocate(SnapshotKind kind) {
+        MemoryManager& heap = *vm.memoryManager;
+        switch (kind) {
+            case SnapshotKind::PROTO: return heap.newObject<ObjFunctionProto>();
+            case SnapshotKind::MODULE: return heap.newObject<ObjModule>();
+            case SnapshotKind::UPVALUE: return heap.newObject<ObjUpvalue>();
+            case SnapshotKind::CLOSURE: return heap.newObject<ObjClosure>();
+            case SnapshotKind::SHAPE: return heap.newObject<ObjShape>();
+            case SnapshotKind::CLASS: return heap.newObject<ObjClass>();
+            case SnapshotKind::INSTANCE: return heap.newObject<ObjInstance>();
+            case SnapshotKind::BOUND_METHOD: return heap.newObject<ObjBoundMethod>();
+            case SnapshotKind::ARRAY: return heap.newObject<ObjArray>();
+            case SnapshotKind::TYPED_ARRAY: {
+                auto arrayKind = in.get<ObjTypedArray::Kind>();
+                if (arrayKind != ObjTypedArray::Kind::INT64 && arrayKind != ObjTypedArray::Kind::FLOAT64) break;
+                return heap.newObject<ObjTypedArray>(arrayKind, in.count<Uint64>());
+            }
+            case SnapshotKind::ROPE: return heap.newObject<ObjRope>(Str(takeString()));
+            case SnapshotKind::OBJECT: return heap.newObject<ObjObject>();
+        }
+        throw VMError("Snapshot hỏng: loại đối tượng không hợp lệ");
+    }
+
+    template <typename T>
+    T* ref() {
+        Uint32 id = in.get<Uint32>();
+        if (id == SNAPSHOT_NO_OBJECT) return nullptr;
+        if constexpr (std::is_same_v<T, ObjModule>) {
+            if (id == SNAPSHOT_BUILTINS) return vm.builtinScope;
+        }
+        if (id >= objects.size() || objects[id].second != kindOf(static_cast<T*>(nullptr))) {
+            throw VMError("Snapshot hỏng: tham chiếu đối tượng không hợp lệ");
+        }
+        return static_cast<T*>(objects[id].first);
+    }
+
+    const Value& native() {
+        Uint32 index = in.get<Uint32>();
+        if (index >= natives.size()) throw VMError("Snapshot hỏng: chỉ số hàm native không hợp lệ");
+        return natives[index];
+    }
+
+    Value value() {
+        switch (in.get<SnapshotTag>()) {
+            case SnapshotTag::NUL: return Value(Null{});
+            case SnapshotTag::INT: return Value(in.get<Int>());
+            case SnapshotTag::REAL: return Value(in.get<Real>());
+            case SnapshotTag::BOOL: return Value(in.get<Uint8>() != 0);
+            case SnapshotTag::STRING: return Value(string());
+            case SnapshotTag::NATIVE: return native();
+            case SnapshotTag::BOUND_NATIVE: {
+                Value function = native();
+                // Receivers are never bindings themselves, which also keeps a corrupt file from nesting them
+                if (readingReceiver) break;
+                readingReceiver = true;
+                Value receiver = value();
+                readingReceiver = false;
+                if (!function.is_native_fn() || std::holds_alternative<BoundNative>(function.get<NativeFn>())) break;
+                return Value(NativeFn(std::make_shared<const BoundNativeFn>(BoundNativeFn{ function.get<NativeFn>(), receiver })));
+            }
+            case SnapshotTag::OBJECT: {
+                Uint32 id = in.get<Uint32>();
+                if (id == SNAPSHOT_BUILTINS) return Value(vm.builtinScope);
+                if (id >= objects.size()) throw VMError("Snapshot hỏng: tham chiếu đối tượng không hợp lệ");
+                MeowObject* object = objects[id].first;
+                switch (objects[id].second) {
+                    case SnapshotKind::PROTO: return Value(static_cast<Proto>(object));
+                    case SnapshotKind::MODULE: return Value(static_cast<Module>(object));
+                    case SnapshotKind::UPVALUE: return Value(static_cast<Upvalue>(object));
+                    case SnapshotKind::CLOSURE: return Value(static_cast<Function>(object));
+                    case SnapshotKind::CLASS: return Value(static_cast<Class>(object));
+                    case SnapshotKind::INSTANCE: return Value(static_cast<Instance>(object));
+                    case SnapshotKind::BOUND_METHOD: return Value(static_cast<BoundMethod>(object));
+                    case SnapshotKind::ARRAY: return Value(static_cast<Array>(object));
+                    case SnapshotKind::TYPED_ARRAY: return Value(static_cast<TypedArray>(object));
+                    case SnapshotKind::ROPE: return Value(static_cast<Rope>(object));
+                    case SnapshotKind::OBJECT: return Value(static_cast<Object>(object));
+                    case SnapshotKind::SHAPE: break;
+                }
+                break;
+            }
+        }
+        throw VMError("Snapshot hỏng: giá trị không hợp lệ");
+    }
+
+    void payload(MeowObject* object, SnapshotKind kind) {
+        switch (kind) {
+            case SnapshotKind::PROTO: {
+                auto proto = static_cast<Proto>(object);
+                proto->numRegisters = in.get<Int>();
+                proto->numUpvalues = in.get<Int>();
+                proto->sourceName = string();
+                proto->code.resize(in.count<Uint32>());
+                for (Instruction& inst : proto->code) {
+                    inst.op = in.get<OpCode>();
+                    if (static_cast<size_t>(inst.op) >= static_cast<size_t>(OpCode::TOTAL_OPCODES)) throw VMError("Snapshot hỏng: opcode không hợp lệ");
+                    inst.cache = in.get<Int>();
+                    inst.firstDead = in.get<Int>();
+                    inst.args.resize(in.count<Uint32>());
+                    for (Int& arg : inst.args) arg = in.get<Int>();
+                }
+                proto->constantPool.resize(in.count<Uint32>());
+                for (Value& constant : proto->constantPool) constant = value();
+                proto->upvalueDescs.resize(in.count<Uint32>());
+                for (UpvalueDesc& desc : proto->upvalueDescs) {
+                    desc.isLocal = in.get<Uint8>() != 0;
+                    desc.index = in.get<Int>();
+                }
+                Uint32 caches = in.get<Uint32>();
+                if (caches > proto->code.size()) throw VMError("Snapshot hỏng: quá nhiều inline cache");
+                proto->propertyCaches.resize(caches);
+                proto->linkedModule = ref<ObjModule>();
+                break;
+            }
+            case SnapshotKind::MODULE: {
+                auto module = static_cast<Module>(object);
+                module->name = string();
+                module->path = string();
+                module->globalSlots.resize(in.count<Uint32>());
+                for (Value& slot : module->globalSlots) slot = value();
+                for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+                    const Str& name = string();
+                    module->globalIndex[name] = in.get<Int>();
+                }
+                module->builtins = ref<ObjModule>();
+                for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+                    const Str& name = string();
+                    module->exports[name] = value();
+                }
+                module->exportSlots.resize(in.count<Uint32>());
+                for (auto*& entry : module->exportSlots) {
+                    entry = nullptr;
+                    if (!in.get<Uint8>()) continue;
+                    auto it = module->exports.find(string());
+                    if (it == module->exports.end()) throw VMError("Snapshot hỏng: export được đánh số không tồn tại");
+                    entry = &*it;
+                }
+                module->mainProto = ref<ObjFunctionProto>();
+                Uint8 flags = in.get<Uint8>();
+                module->isExecuted = flags & 1;
+                module->isBinary = flags & 2;
+                module->hasMain = (flags & 4) && module->mainProto;
+                module->isExecuting = flags & 8;
+                break;
+            }
+            case SnapshotKind::UPVALUE: {
+                auto upvalue = static_cast<Upvalue>(object);
+                upvalue->state = in.get<Uint8>() ? ObjUpvalue::State::CLOSED : ObjUpvalue::State::OPEN;
+                upvalue->slotIndex = in.get<Int>();
+                upvalue->closed = value();
+                break;
+            }
+            case SnapshotKind::CLOSURE: {
+                auto closure = static_cast<Function>(object);
+                closure->proto = ref<ObjFunctionProto>();
+                closure->upvalues.resize(in.count<Uint32>());
+                for (Upvalue& upvalue : closure->upvalues) upvalue = ref<ObjUpvalue>();
+                if (!closure->proto) throw VMError("Snapshot hỏng: closure không có hàm");
+                break;
+            }
+            case SnapshotKind::SHAPE: {
+                auto shape = static_cast<Shape>(object);
+                shape->parent = ref<ObjShape>();
+                shape->name = string();
+                shape->slotCount = in.get<Int>();
+                for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+                    const Str& name = string();
+                    shape->transitions[name] = ref<ObjShape>();
+                }
+                break;
+            }
+            case SnapshotKind::CLASS: {
+                auto klass = static_cast<Class>(object);
+                klass->name = string();
+                Class superclass = ref<ObjClass>();
+                if (in.get<Uint8>()) klass->superclass = superclass;
+                for (Uint32 n = in.count<Uint32>(); n > 0; --n) {
+                    const Str& name = string();
+                    klass->methods[name] = value();
+                }
+                klass->instanceShape = ref<ObjShape>();
+                break;
+            }
+            case SnapshotKind::INSTANCE: {
+                auto instance = static_cast<Instance>(object);
+                instance->klass = ref<ObjClass>();
+                instance->shape = ref<ObjShape>();
+                Uint32 used = in.get<Uint32>();
+                if (used > static_cast<Uint32>(ObjInstance::INLINE_SLOTS)) throw VMError("Snapshot hỏng: quá nhiều ô nội tuyến");
+                for (Uint32 i = 0; i < used; ++i) instance->inlineSlots[i] = value();
+                instance->extraSlots.resize(in.count<Uint32>());
+                for (Value& slot : instance->extraSlots) slot = value();
+                if (in.get<Uint8>()) {
+                    instance->dictionary = std::make_unique<ValueTable>();
+                    table(*instance->dictionary);
+                }
+                break;
+            }
+            case SnapshotKind::BOUND_METHOD: {
+                auto bound = static_cast<BoundMethod>(object);
+                bound->receiver = ref<ObjInstance>();
+                bound->callable = ref<ObjClosure>();
+                break;
+            }
+            case SnapshotKind::ARRAY: {
+                auto array = static_cast<Array>(object);
+                auto arrayKind = in.get<ObjArray::ElementsKind>();
+                size_t size = in.count<Uint64>();
+                // An empty array picks its packed kind from the first element; a GENERIC one has to stay GENERIC.
+                // Reserving once the kind is settled keeps the other storages unallocated
+                if (arrayKind == ObjArray::ElementsKind::GENERIC) array->toGeneric();
+                for (size_t i = 0; i < size; ++i) {
+                    array->push(value());
+                    if (i == 0) array->reserve(size);
+                }
+                break;
+            }
+            case SnapshotKind::TYPED_ARRAY: {
+                auto array = static_cast<TypedArray>(object);
+                std::string_view raw = in.take(array->size() * 8);
+                char* out = array->isFloat() ? reinterpret_cast<char*>(array->reals()) : reinterpret_cast<char*>(array->ints());
+                if (!raw.empty()) std::memcpy(out, raw.data(), raw.size());
+                break;
+            }
+            case SnapshotKind::ROPE:
+                break;
+            case SnapshotKind::OBJECT:
+                table(static_cast<Object>(object)->fields);
+                break;
+        }
+    }
+
+    void table(ValueTable& entries) {
+        for (Uint64 n = in.count<Uint64>(); n > 0; --n) {
+            Value key = value();
+            entries[key] = value();
+        }
+    }
+};
+
+// --- VM side ---
+
+void MeowVM::setSnapshotOutput(const Str& path) {
+    snapshotPath = path;
+    if (path.empty()) return;
+    // Natives registered from now on are tagged as they are inserted (see _snapshotMethod)
+    for (auto& [name, slot] : builtinScope->globalIndex) {
+        builtinScope->globalSlots[slot] = tagNative(builtinScope->globalSlots[slot], builtinKey(name));
+    }
+    for (auto& [type, methods] : builtinMethods) {
+        for (auto& [name, method] : methods) method = tagNative(method, methodKey(type, name));
+    }
+    for (auto& [type, getters] : builtinGetters) {
+        for (auto& [name, getter] : getters) getter = tagNative(getter, getterKey(type, name));
+    }
+}
+
+Value MeowVM::_snapshotMethod(const Str& type, const Str& name, const Value& method) const {
+    return snapshotPath.empty() ? method : tagNative(method, methodKey(type, name));
+}
+
+Value MeowVM::_snapshotGetter(const Str& type, const Str& name, const Value& getter) const {
+    return snapshotPath.empty() ? getter : tagNative(getter, getterKey(type, name));
+}
+
+void MeowVM::_tagLibraryNatives(Module library, const Str& libPath) {
+    for (auto& [name, slot] : library->globalIndex) {
+        library->globalSlots[slot] = tagNative(library->globalSlots[slot], libraryKey(libPath, "global", name));
+    }
+    for (auto& [name, exported] : library->exports) exported = tagNative(exported, libraryKey(libPath, "export", name));
+}
+
+void MeowVM::_writeSnapshot() {
+    snapshotPending = false;
+    if (nestedCalls > 0) throwVMError("snapshot_point() phải được gọi trực tiếp từ mã MeowScript, không qua một hàm native");
+    SnapshotWriter(*this).write(snapshotPath);
+    // Everything after the snapshot point belongs to the runs that load it
+    callStack.clear();
+    snapshotWritten = true;
+}
+
+void MeowVM::resume(const Str& snapshotFile) {
+    callStack.clear();
+    stackSlots.clear();
+    openUpvalues.clear();
+    exceptionHandlers.clear();
+    handleStack.clear();
+
+    try {
+        memoryManager->disableGC();
+        try {
+            SnapshotReader(*this).read(snapshotFile);
+        } catch (...) {
+            callStack.clear();
+            stackSlots.clear();
+            openUpvalues.clear();
+            moduleCache.clear();
+            memoryManager->enableGC();
+            throw;
+        }
+        memoryManager->enableGC();
+        run();
+    } catch (const VMError& e) {
+        std::cerr << "💥 Lỗi nghiêm trọng trong MeowScript VM: " << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "🤯 Lỗi C++ không lường trước: " << e.what() << std::endl;
+    }
+}
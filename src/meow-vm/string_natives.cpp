@@ -0,0 +1,39 @@
+#include "meow_vm.h"
+
+void MeowVM::defineStringNatives() {
+    // Methods get the string as their receiver; it may be a Str or a Rope.
+    // Positions and lengths count characters (see Utf8Index)
+    auto length = [this](MeowEngine*, const Value& self, Arguments) -> Value {
+        Utf8Index scratch;
+        return Value(static_cast<Int>(_utf8Index(self, scratch).length()));
+    };
+    // slice(start[, end]) -> characters in [start, end); negative positions count from the end
+    auto slice = [this](MeowEngine*, const Value& self, Arguments args) -> Value {
+        if (args.empty() || !args[0].is_int() || (args.size() > 1 && !args[1].is_int())) {
+            throwVMError("String.slice(): cần vị trí bắt đầu (và kết thúc) là số nguyên");
+        }
+        Utf8Index scratch;
+        const Utf8Index& chars = _utf8Index(self, scratch);
+        std::string_view text = _stringView(self);
+        Int size = static_cast<Int>(chars.length());
+        auto clamp = [size](Int pos) { return std::clamp(pos < 0 ? pos + size : pos, Int{0}, size); };
+        Int start = clamp(args[0].get<Int>());
+        Int end = args.size() > 1 ? clamp(args[1].get<Int>()) : size;
+        if (end <= start) return Value(Str());
+        size_t begin = chars.byteOffset(text, static_cast<size_t>(start));
+        size_t count = chars.byteOffset(text, static_cast<size_t>(end)) - begin;
+
+        // Long slices of heap strings share the parent's buffer; anything else is cheaper to copy
+        if (self.is_rope() && count >= ObjRope::MIN_LENGTH) {
+            return Value(memoryManager->newObject<ObjRope>(self.get<Rope>(), begin, count));
+        }
+        return Value(Str(text.substr(begin, count)));
+    };
+
+    register_getters("String", {
+        { "length", Value(length) },
+    });
+    register_methods("String", {
+        { "slice", Value(slice) },
+    });
+}
@@ -0,0 +1,187 @@
+#include "meow_vm.h"
+#include "runtime/typed_array_kernels.h"
+
+// Int64Array against a real operand is rare, so it just compares in doubles without a kernel
+static void compareIntsWithReal(Int* out, const Int* in, Real operand, CompareOp op, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Real v = static_cast<Real>(in[i]);
+        bool result = false;
+        switch (op) {
+            case CompareOp::LT: result = v < operand; break;
+            case CompareOp::LE: result = v <= operand; break;
+            case CompareOp::GT: result = v > operand; break;
+            case CompareOp::GE: result = v >= operand; break;
+            case CompareOp::EQ: result = v == operand; break;
+            case CompareOp::NE: result = v != operand; break;
+        }
+        out[i] = result ? 1 : 0;
+    }
+}
+
+void MeowVM::defineTypedArrayNatives(std::unordered_map<Str, Value>& natives) {
+    using Kind = ObjTypedArray::Kind;
+
+    // Int64Array(n) / Float64Array(n) -> zero-filled; Int64Array(array) -> converted copy
+    auto makeConstructor = [this](Kind kind) {
+        return [this, kind](Arguments args) -> Value {
+            Str name = kind == Kind::FLOAT64 ? "Float64Array" : "Int64Array";
+            if (args.size() != 1) throwVMError(name + "() nhận đúng 1 tham số");
+            const Value& source = args[0];
+
+            if (source.is_int()) {
+                Int size = source.get<Int>();
+                if (size < 0) throwVMError(name + "(): kích thước không hợp lệ");
+                return Value(memoryManager->newObject<ObjTypedArray>(kind, static_cast<size_t>(size)));
+            }
+            if (source.is_array()) {
+                Array elements = source.get<Array>();
+                TypedArray result = memoryManager->newObject<ObjTypedArray>(kind, elements->size());
+                for (size_t i = 0; i < elements->size(); ++i) {
+                    if (!result->set(i, elements->get(i))) {
+                        throwVMError(name + "(): phần tử '" + _toString(elements->get(i)) + "' không phải là số");
+                    }
+                }
+                return Value(result);
+            }
+            if (source.is_typed_array()) {
+                TypedArray other = source.get<TypedArray>();
+                TypedArray result = memoryManager->newObject<ObjTypedArray>(kind, other->size());
+                for (size_t i = 0; i < other->size(); ++i) result->set(i, other->get(i));
+                return Value(result);
+            }
+            throwVMError(name + "(): cần một số nguyên hoặc một mảng");
+        };
+    };
+    natives["Int64Array"] = Value(makeConstructor(Kind::INT64));
+    natives["Float64Array"] = Value(makeConstructor(Kind::FLOAT64));
+
+    // Methods get the array as their receiver
+    auto self = [](const Value& receiver) { return receiver.get<TypedArray>(); };
+    auto sameShape = [this](TypedArray a, const Value& other, const char* method) {
+        if (!other.is_typed_array() || other.get<TypedArray>()->kind() != a->kind() || other.get<TypedArray>()->size() != a->size()) {
+            throwVMError(Str(a->typeName()) + "." + method + "(): cần một " + a->typeName() + " cùng độ dài");
+        }
+        return other.get<TypedArray>();
+    };
+    auto argument = [this](TypedArray arr, Arguments args, const char* method) -> const Value& {
+        if (args.empty()) throwVMError(Str(arr->typeName()) + "." + method + "() thiếu tham số");
+        return args[0];
+    };
+
+    auto length = [self](MeowEngine*, const Value& receiver, Arguments) -> Value {
+        return Value(static_cast<Int>(self(receiver)->size()));
+    };
+    auto sum = [self](MeowEngine*, const Value& receiver, Arguments) -> Value {
+        TypedArray arr = self(receiver);
+        if (arr->isFloat()) return Value(typed_sum_f64(arr->reals(), arr->size()));
+        return Value(typed_sum_i64(arr->ints(), arr->size()));
+    };
+    auto extremum = [self](bool wantMax) {
+        return [self, wantMax](MeowEngine*, const Value& receiver, Arguments) -> Value {
+            TypedArray arr = self(receiver);
+            if (arr->empty()) return Value(Null{});
+            if (arr->isFloat()) {
+                Real lo, hi;
+                typed_min_max_f64(arr->reals(), arr->size(), lo, hi);
+                return Value(wantMax ? hi : lo);
+            }
+            Int lo, hi;
+            typed_min_max_i64(arr->ints(), arr->size(), lo, hi);
+            return Value(wantMax ? hi : lo);
+        };
+    };
+    auto dot = [self, sameShape, argument](MeowEngine*, const Value& receiver, Arguments args) -> Value {
+        TypedArray a = self(receiver);
+        TypedArray b = sameShape(a, argument(a, args, "dot"), "dot");
+        if (a->isFloat()) return Value(typed_dot_f64(a->reals(), b->reals(), a->size()));
+        return Value(typed_dot_i64(a->ints(), b->ints(), a->size()));
+    };
+    auto scale = [this, self, argument](MeowEngine*, const Value& receiver, Arguments args) -> Value {
+        TypedArray arr = self(receiver);
+        const Value& factor = argument(arr, args, "scale");
+        TypedArray result = memoryManager->newObject<ObjTypedArray>(arr->kind(), arr->size());
+        if (arr->isFloat()) {
+            if (!factor.is_int() && !factor.is_real()) throwVMError("Float64Array.scale(): hệ số phải là số");
+            typed_scale_f64(result->reals(), arr->reals(), _toDouble(factor), arr->size());
+        } else {
+            if (!factor.is_int()) throwVMError("Int64Array.scale(): hệ số phải là số nguyên");
+            typed_scale_i64(result->ints(), arr->ints(), factor.get<Int>(), arr->size());
+        }
+        return Value(result);
+    };
+    auto add = [this, self, sameShape, argument](MeowEngine*, const Value& receiver, Arguments args) -> Value {
+        TypedArray a = self(receiver);
+        TypedArray b = sameShape(a, argument(a, args, "add"), "add");
+        TypedArray result = memoryManager->newObject<ObjTypedArray>(a->kind(), a->size());
+        if (a->isFloat()) typed_add_f64(result->reals(), a->reals(), b->reals(), a->size());
+        else typed_add_i64(result->ints(), a->ints(), b->ints(), a->size());
+        return Value(result);
+    };
+    // lt/le/gt/ge/eq/ne(x) -> Int64Array mask of 0/1
+    auto compare = [this, self, argument](CompareOp op, const char* method) {
+        return [this, self, argument, op, method](MeowEngine*, const Value& receiver, Arguments args) -> Value {
+            TypedArray arr = self(receiver);
+            const Value& operand = argument(arr, args, method);
+            if (!operand.is_int() && !operand.is_real()) {
+                throwVMError(Str(arr->typeName()) + "." + method + "(): cần một số");
+            }
+            TypedArray mask = memoryManager->newObject<ObjTypedArray>(Kind::INT64, arr->size());
+            if (arr->isFloat()) {
+                typed_compare_f64(mask->ints(), arr->reals(), _toDouble(operand), op, arr->size());
+            } else if (operand.is_int()) {
+                typed_compare_i64(mask->ints(), arr->ints(), operand.get<Int>(), op, arr->size());
+            } else {
+                compareIntsWithReal(mask->ints(), arr->ints(), operand.get<Real>(), op, arr->size());
+            }
+            return Value(mask);
+        };
+    };
+    // filter(mask) -> elements whose mask entry is non-zero
+    auto filter = [this, self, argument](MeowEngine*, const Value& receiver, Arguments args) -> Value {
+        TypedArray arr = self(receiver);
+        const Value& maskVal = argument(arr, args, "filter");
+        if (!maskVal.is_typed_array() || maskVal.get<TypedArray>()->isFloat() || maskVal.get<TypedArray>()->size() != arr->size()) {
+            throwVMError(Str(arr->typeName()) + ".filter(): cần một Int64Array mask cùng độ dài");
+        }
+        const Int* mask = maskVal.get<TypedArray>()->ints();
+        size_t kept = 0;
+        for (size_t i = 0; i < arr->size(); ++i) kept += mask[i] != 0;
+
+        TypedArray result = memoryManager->newObject<ObjTypedArray>(arr->kind(), kept);
+        for (size_t i = 0, out = 0; i < arr->size(); ++i) {
+            if (!mask[i]) continue;
+            if (arr->isFloat()) result->reals()[out++] = arr->reals()[i];
+            else result->ints()[out++] = arr->ints()[i];
+        }
+        return Value(result);
+    };
+    auto toArray = [this, self](MeowEngine*, const Value& receiver, Arguments) -> Value {
+        TypedArray arr = self(receiver);
+        Array result = memoryManager->newObject<ObjArray>();
+        result->reserve(arr->size());
+        for (size_t i = 0; i < arr->size(); ++i) result->push(arr->get(i));
+        return Value(result);
+    };
+
+    for (const char* type : { "Int64Array", "Float64Array" }) {
+        register_getters(type, {
+            { "length", Value(length) },
+        });
+        register_methods(type, {
+            { "sum", Value(sum) },
+            { "min", Value(extremum(false)) },
+            { "max", Value(extremum(true)) },
+            { "dot", Value(dot) },
+            { "scale", Value(scale) },
+            { "add", Value(add) },
+            { "lt", Value(compare(CompareOp::LT, "lt")) },
+            { "le", Value(compare(CompareOp::LE, "le")) },
+            { "gt", Value(compare(CompareOp::GT, "gt")) },
+            { "ge", Value(compare(CompareOp::GE, "ge")) },
+            { "eq", Value(compare(CompareOp::EQ, "eq")) },
+            { "ne", Value(compare(CompareOp::NE, "ne")) },
+            { "filter", Value(filter) },
+            { "toArray", Value(toArray) },
+        });
+    }
+}
@@ -0,0 +1,454 @@
+#include "runtime/typed_array_kernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MEOW_KERNELS_X86 1
+#define MEOW_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#else
+#define MEOW_KERNELS_X86 0
+#endif
+
+template <typename T>
+static inline bool kernelCompare(T a, T b, CompareOp op) noexcept {
+    switch (op) {
+        case CompareOp::LT: return a < b;
+        case CompareOp::LE: return a <= b;
+        case CompareOp::GT: return a > b;
+        case CompareOp::GE: return a >= b;
+        case CompareOp::EQ: return a == b;
+        case CompareOp::NE: return a != b;
+    }
+    return false;
+}
+
+// --- Scalar bodies (also used for the tails of the vector loops) ---
+
+static Real sumF64Scalar(const Real* data, size_t count) noexcept {
+    Real sum = 0.0;
+    for (size_t i = 0; i < count; ++i) sum += data[i];
+    return sum;
+}
+
+static Int sumI64Scalar(const Int* data, size_t count) noexcept {
+    Uint64 sum = 0;
+    for (size_t i = 0; i < count; ++i) sum += static_cast<Uint64>(data[i]);
+    return static_cast<Int>(sum);
+}
+
+template <typename T>
+static void minMaxScalar(const T* data, size_t count, T& min, T& max) noexcept {
+    min = max = data[0];
+    for (size_t i = 1; i < count; ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+    }
+}
+
+// std::min/std::max and the min/max instructions all drop a NaN or keep it depending on where it sits,
+// so every float kernel tracks NaNs on the side and reports NaN for both results if it saw one
+static constexpr Real NOT_A_NUMBER = std::numeric_limits<Real>::quiet_NaN();
+
+static void minMaxF64Scalar(const Real* data, size_t count, Real& min, Real& max) noexcept {
+    Bool sawNaN = false;
+    min = max = data[0];
+    for (size_t i = 0; i < count; ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+        sawNaN |= std::isnan(data[i]);
+    }
+    if (sawNaN) min = max = NOT_A_NUMBER;
+}
+
+static Real dotF64Scalar(const Real* a, const Real* b, size_t count) noexcept {
+    Real sum = 0.0;
+    for (size_t i = 0; i < count; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+static void scaleF64Scalar(Real* out, const Real* in, Real factor, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) out[i] = in[i] * factor;
+}
+
+static void addF64Scalar(Real* out, const Real* a, const Real* b, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) out[i] = a[i] + b[i];
+}
+
+static void addI64Scalar(Int* out, const Int* a, const Int* b, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) out[i] = static_cast<Int>(static_cast<Uint64>(a[i]) + static_cast<Uint64>(b[i]));
+}
+
+template <typename T>
+static void compareScalar(Int* out, const T* in, T operand, CompareOp op, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) out[i] = kernelCompare(in[i], operand, op) ? 1 : 0;
+}
+
+#if MEOW_KERNELS_X86
+
+// --- SSE2 bodies (always available on x86-64) ---
+
+static Real sumF64Sse2(const Real* data, size_t count) noexcept {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(data + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(data + i + 2));
+    }
+    alignas(16) Real lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + sumF64Scalar(data + i, count - i);
+}
+
+static Int sumI64Sse2(const Int* data, size_t count) noexcept {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    alignas(16) Int lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return static_cast<Int>(static_cast<Uint64>(lanes[0]) + static_cast<Uint64>(lanes[1]) +
+                            static_cast<Uint64>(sumI64Scalar(data + i, count - i)));
+}
+
+static void minMaxF64Sse2(const Real* data, size_t count, Real& min, Real& max) noexcept {
+    if (count < 2) return minMaxF64Scalar(data, count, min, max);
+    __m128d lo = _mm_loadu_pd(data), hi = lo;
+    __m128d nan = _mm_cmpunord_pd(lo, lo);
+    size_t i = 2;
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_loadu_pd(data + i);
+        lo = _mm_min_pd(lo, v);
+        hi = _mm_max_pd(hi, v);
+        nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+    }
+    alignas(16) Real los[2], his[2];
+    _mm_store_pd(los, lo);
+    _mm_store_pd(his, hi);
+    min = std::min(los[0], los[1]);
+    max = std::max(his[0], his[1]);
+    Bool sawNaN = _mm_movemask_pd(nan) != 0;
+    for (; i < count; ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+        sawNaN |= std::isnan(data[i]);
+    }
+    if (sawNaN) min = max = NOT_A_NUMBER;
+}
+
+static Real dotF64Sse2(const Real* a, const Real* b, size_t count) noexcept {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    alignas(16) Real lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + dotF64Scalar(a + i, b + i, count - i);
+}
+
+static void scaleF64Sse2(Real* out, const Real* in, Real factor, size_t count) noexcept {
+    __m128d k = _mm_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(in + i), k));
+    scaleF64Scalar(out + i, in + i, factor, count - i);
+}
+
+static void addF64Sse2(Real* out, const Real* a, const Real* b, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    addF64Scalar(out + i, a + i, b + i, count - i);
+}
+
+static void addI64Sse2(Int* out, const Int* a, const Int* b, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi64(va, vb));
+    }
+    addI64Scalar(out + i, a + i, b + i, count - i);
+}
+
+template <CompareOp Op>
+static void compareF64Sse2Body(Int* out, const Real* in, Real operand, size_t count) noexcept {
+    __m128d x = _mm_set1_pd(operand);
+    __m128i one = _mm_set1_epi64x(1);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_loadu_pd(in + i);
+        __m128d m;
+        if constexpr (Op == CompareOp::LT) m = _mm_cmplt_pd(v, x);
+        else if constexpr (Op == CompareOp::LE) m = _mm_cmple_pd(v, x);
+        else if constexpr (Op == CompareOp::GT) m = _mm_cmpgt_pd(v, x);
+        else if constexpr (Op == CompareOp::GE) m = _mm_cmpge_pd(v, x);
+        else if constexpr (Op == CompareOp::EQ) m = _mm_cmpeq_pd(v, x);
+        else m = _mm_cmpneq_pd(v, x);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(_mm_castpd_si128(m), one));
+    }
+    compareScalar(out + i, in + i, operand, Op, count - i);
+}
+
+static void compareF64Sse2(Int* out, const Real* in, Real operand, CompareOp op, size_t count) noexcept {
+    switch (op) {
+        case CompareOp::LT: return compareF64Sse2Body<CompareOp::LT>(out, in, operand, count);
+        case CompareOp::LE: return compareF64Sse2Body<CompareOp::LE>(out, in, operand, count);
+        case CompareOp::GT: return compareF64Sse2Body<CompareOp::GT>(out, in, operand, count);
+        case CompareOp::GE: return compareF64Sse2Body<CompareOp::GE>(out, in, operand, count);
+        case CompareOp::EQ: return compareF64Sse2Body<CompareOp::EQ>(out, in, operand, count);
+        case CompareOp::NE: return compareF64Sse2Body<CompareOp::NE>(out, in, operand, count);
+    }
+}
+
+// --- AVX2 bodies (picked at runtime) ---
+
+MEOW_TARGET_AVX2 static Real sumF64Avx2(const Real* data, size_t count) noexcept {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+    }
+    alignas(32) Real lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sumF64Scalar(data + i, count - i);
+}
+
+MEOW_TARGET_AVX2 static Int sumI64Avx2(const Int* data, size_t count) noexcept {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+    }
+    alignas(32) Int lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    Uint64 sum = static_cast<Uint64>(sumI64Scalar(data + i, count - i));
+    for (Int lane : lanes) sum += static_cast<Uint64>(lane);
+    return static_cast<Int>(sum);
+}
+
+MEOW_TARGET_AVX2 static void minMaxF64Avx2(const Real* data, size_t count, Real& min, Real& max) noexcept {
+    if (count < 4) return minMaxF64Scalar(data, count, min, max);
+    __m256d lo = _mm256_loadu_pd(data), hi = lo;
+    __m256d nan = _mm256_cmp_pd(lo, lo, _CMP_UNORD_Q);
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(data + i);
+        lo = _mm256_min_pd(lo, v);
+        hi = _mm256_max_pd(hi, v);
+        nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+    }
+    alignas(32) Real los[4], his[4];
+    _mm256_store_pd(los, lo);
+    _mm256_store_pd(his, hi);
+    min = los[0];
+    max = his[0];
+    for (int lane = 1; lane < 4; ++lane) {
+        min = std::min(min, los[lane]);
+        max = std::max(max, his[lane]);
+    }
+    Bool sawNaN = _mm256_movemask_pd(nan) != 0;
+    for (; i < count; ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+        sawNaN |= std::isnan(data[i]);
+    }
+    if (sawNaN) min = max = NOT_A_NUMBER;
+}
+
+MEOW_TARGET_AVX2 static void minMaxI64Avx2(const Int* data, size_t count, Int& min, Int& max) noexcept {
+    if (count < 4) return minMaxScalar(data, count, min, max);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), hi = lo;
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        lo = _mm256_blendv_epi8(lo, v, _mm256_cmpgt_epi64(lo, v));
+        hi = _mm256_blendv_epi8(hi, v, _mm256_cmpgt_epi64(v, hi));
+    }
+    alignas(32) Int los[4], his[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(los), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(his), hi);
+    min = los[0];
+    max = his[0];
+    for (int lane = 1; lane < 4; ++lane) {
+        min = std::min(min, los[lane]);
+        max = std::max(max, his[lane]);
+    }
+    for (; i < count; ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+    }
+}
+
+MEOW_TARGET_AVX2 static Real dotF64Avx2(const Real* a, const Real* b, size_t count) noexcept {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    alignas(32) Real lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotF64Scalar(a + i, b + i, count - i);
+}
+
+MEOW_TARGET_AVX2 static void scaleF64Avx2(Real* out, const Real* in, Real factor, size_t count) noexcept {
+    __m256d k = _mm256_set1_pd(factor);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(in + i), k));
+    scaleF64Scalar(out + i, in + i, factor, count - i);
+}
+
+MEOW_TARGET_AVX2 static void addF64Avx2(Real* out, const Real* a, const Real* b, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    addF64Scalar(out + i, a + i, b + i, count - i);
+}
+
+MEOW_TARGET_AVX2 static void addI64Avx2(Int* out, const Int* a, const Int* b, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(va, vb));
+    }
+    addI64Scalar(out + i, a + i, b + i, count - i);
+}
+
+template <CompareOp Op>
+MEOW_TARGET_AVX2 static void compareF64Avx2Body(Int* out, const Real* in, Real operand, size_t count) noexcept {
+    __m256d x = _mm256_set1_pd(operand);
+    __m256i one = _mm256_set1_epi64x(1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(in + i);
+        __m256d m;
+        if constexpr (Op == CompareOp::LT) m = _mm256_cmp_pd(v, x, _CMP_LT_OQ);
+        else if constexpr (Op == CompareOp::LE) m = _mm256_cmp_pd(v, x, _CMP_LE_OQ);
+        else if constexpr (Op == CompareOp::GT) m = _mm256_cmp_pd(v, x, _CMP_GT_OQ);
+        else if constexpr (Op == CompareOp::GE) m = _mm256_cmp_pd(v, x, _CMP_GE_OQ);
+        else if constexpr (Op == CompareOp::EQ) m = _mm256_cmp_pd(v, x, _CMP_EQ_OQ);
+        else m = _mm256_cmp_pd(v, x, _CMP_NEQ_UQ);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(_mm256_castpd_si256(m), one));
+    }
+    compareScalar(out + i, in + i, operand, Op, count - i);
+}
+
+MEOW_TARGET_AVX2 static void compareF64Avx2(Int* out, const Real* in, Real operand, CompareOp op, size_t count) noexcept {
+    switch (op) {
+        case CompareOp::LT: return compareF64Avx2Body<CompareOp::LT>(out, in, operand, count);
+        case CompareOp::LE: return compareF64Avx2Body<CompareOp::LE>(out, in, operand, count);
+        case CompareOp::GT: return compareF64Avx2Body<CompareOp::GT>(out, in, operand, count);
+        case CompareOp::GE: return compareF64Avx2Body<CompareOp::GE>(out, in, operand, count);
+        case CompareOp::EQ: return compareF64Avx2Body<CompareOp::EQ>(out, in, operand, count);
+        case CompareOp::NE: return compareF64Avx2Body<CompareOp::NE>(out, in, operand, count);
+    }
+}
+
+template <CompareOp Op>
+MEOW_TARGET_AVX2 static void compareI64Avx2Body(Int* out, const Int* in, Int operand, size_t count) noexcept {
+    __m256i x = _mm256_set1_epi64x(operand);
+    __m256i one = _mm256_set1_epi64x(1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        // AVX2 only has == and >, so the other predicates are negations of those
+        __m256i m;
+        if constexpr (Op == CompareOp::LT) m = _mm256_cmpgt_epi64(x, v);
+        else if constexpr (Op == CompareOp::LE) m = _mm256_andnot_si256(_mm256_cmpgt_epi64(v, x), one);
+        else if constexpr (Op == CompareOp::GT) m = _mm256_cmpgt_epi64(v, x);
+        else if constexpr (Op == CompareOp::GE) m = _mm256_andnot_si256(_mm256_cmpgt_epi64(x, v), one);
+        else if constexpr (Op == CompareOp::EQ) m = _mm256_cmpeq_epi64(v, x);
+        else m = _mm256_andnot_si256(_mm256_cmpeq_epi64(v, x), one);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(m, one));
+    }
+    compareScalar(out + i, in + i, operand, Op, count - i);
+}
+
+MEOW_TARGET_AVX2 static void compareI64Avx2(Int* out, const Int* in, Int operand, CompareOp op, size_t count) noexcept {
+    switch (op) {
+        case CompareOp::LT: return compareI64Avx2Body<CompareOp::LT>(out, in, operand, count);
+        case CompareOp::LE: return compareI64Avx2Body<CompareOp::LE>(out, in, operand, count);
+        case CompareOp::GT: return compareI64Avx2Body<CompareOp::GT>(out, in, operand, count);
+        case CompareOp::GE: return compareI64Avx2Body<CompareOp::GE>(out, in, operand, count);
+        case CompareOp::EQ: return compareI64Avx2Body<CompareOp::EQ>(out, in, operand, count);
+        case CompareOp::NE: return compareI64Avx2Body<CompareOp::NE>(out, in, operand, count);
+    }
+}
+
+#endif // MEOW_KERNELS_X86
+
+// --- Runtime dispatch ---
+
+struct TypedKernelTable {
+    const char* isa;
+    Real (*sumF64)(const Real*, size_t) noexcept;
+    Int (*sumI64)(const Int*, size_t) noexcept;
+    void (*minMaxF64)(const Real*, size_t, Real&, Real&) noexcept;
+    void (*minMaxI64)(const Int*, size_t, Int&, Int&) noexcept;
+    Real (*dotF64)(const Real*, const Real*, size_t) noexcept;
+    void (*scaleF64)(Real*, const Real*, Real, size_t) noexcept;
+    void (*addF64)(Real*, const Real*, const Real*, size_t) noexcept;
+    void (*addI64)(Int*, const Int*, const Int*, size_t) noexcept;
+    void (*compareF64)(Int*, const Real*, Real, CompareOp, size_t) noexcept;
+    void (*compareI64)(Int*, const Int*, Int, CompareOp, size_t) noexcept;
+};
+
+static TypedKernelTable selectTypedKernels() noexcept {
+#if MEOW_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return { "avx2", sumF64Avx2, sumI64Avx2, minMaxF64Avx2, minMaxI64Avx2, dotF64Avx2,
+                 scaleF64Avx2, addF64Avx2, addI64Avx2, compareF64Avx2, compareI64Avx2 };
+    }
+    // SSE2 has no 64-bit integer compare, so those stay scalar
+    return { "sse2", sumF64Sse2, sumI64Sse2, minMaxF64Sse2, minMaxScalar<Int>, dotF64Sse2,
+             scaleF64Sse2, addF64Sse2, addI64Sse2, compareF64Sse2, compareScalar<Int> };
+#else
+    return { "scalar", sumF64Scalar, sumI64Scalar, minMaxF64Scalar, minMaxScalar<Int>, dotF64Scalar,
+             scaleF64Scalar, addF64Scalar, addI64Scalar, compareScalar<Real>, compareScalar<Int> };
+#endif
+}
+
+static const TypedKernelTable& typedKernels() noexcept {
+    static const TypedKernelTable table = selectTypedKernels();
+    return table;
+}
+
+Real typed_sum_f64(const Real* data, size_t count) noexcept { return typedKernels().sumF64(data, count); }
+Int typed_sum_i64(const Int* data, size_t count) noexcept { return typedKernels().sumI64(data, count); }
+
+void typed_min_max_f64(const Real* data, size_t count, Real& min, Real& max) noexcept {
+    typedKernels().minMaxF64(data, count, min, max);
+}
+void typed_min_max_i64(const Int* data, size_t count, Int& min, Int& max) noexcept {
+    typedKernels().minMaxI64(data, count, min, max);
+}
+
+Real typed_dot_f64(const Real* a, const Real* b, size_t count) noexcept { return typedKernels().dotF64(a, b, count); }
+
+// No 64-bit integer multiply below AVX-512, so the integer products stay scalar everywhere
+Int typed_dot_i64(const Int* a, const Int* b, size_t count) noexcept {
+    Uint64 sum = 0;
+    for (size_t i = 0; i < count; ++i) sum += static_cast<Uint64>(a[i]) * static_cast<Uint64>(b[i]);
+    return static_cast<Int>(sum);
+}
+
+void typed_scale_f64(Real* out, const Real* in, Real factor, size_t count) noexcept {
+    typedKernels().scaleF64(out, in, factor, count);
+}
+void typed_scale_i64(Int* out, const Int* in, Int factor, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) out[i] = static_cast<Int>(static_cast<Uint64>(in[i]) * static_cast<Uint64>(factor));
+}
+
+void typed_add_f64(Real* out, const Real* a, const Real* b, size_t count) noexcept { typedKernels().addF64(out, a, b, count); }
+void typed_add_i64(Int* out, const Int* a, const Int* b, size_t count) noexcept { typedKernels().addI64(out, a, b, count); }
+
+void typed_compare_f64(Int* out, const Real* in, Real operand, CompareOp op, size_t count) noexcept {
+    typedKernels().compareF64(out, in, operand, op, count);
+}
+void typed_compare_i64(Int* out, const Int* in, Int operand, CompareOp op, size_t count) noexcept {
+    typedKernels().compareI64(out, in, operand, op, count);
+}
+
+const char* typed_kernels_isa() noexcept { return typedKernels().isa; }
@@ -0,0 +1,49 @@
+#include "bytecode_parser.h"
+#include "binary_format.h"
+
+// meow-asm: assembles text bytecode (.meow) into the binary module format (.meowb)
+int main(int argc, char* argv[]) {
+    std::string inputPath;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (inputPath.empty()) {
+            inputPath = arg;
+        } else {
+            inputPath.clear();
+            break;
+        }
+    }
+
+    if (inputPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <input.meow> [-o <output.meowb>]" << std::endl;
+        return 1;
+    }
+    if (outputPath.empty()) {
+        outputPath = std::filesystem::path(inputPath).replace_extension(".meowb").string();
+    }
+
+    BytecodeParser parser;
+    ParsedModule module = parser.readFile(inputPath);
+    if (!module.error.empty()) {
+        std::cerr << module.error << std::endl;
+        return 1;
+    }
+
+    std::vector<char> image;
+    std::string error;
+    if (!writeBinaryModule(module, image, error)) {
+        std::cerr << "Lỗi: " << error << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+        std::cerr << "Lỗi: không thể ghi file " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
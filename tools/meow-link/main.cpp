@@ -0,0 +1,206 @@
+#include "bytecode_parser.h"
+#include "binary_format.h"
+#include "module_resolver.h"
+
+#include <map>
+
+// meow-link: bundles a text program and every module it statically imports into one linked image (.meowl)
+
+namespace {
+    const Str PROTO_PREFIX = "::function_proto::";
+
+    struct LinkInput {
+        Str path;                   // absolute path of the source
+        Str key;                    // path relative to the image's directory; importers' IMPORT_MODULE constants are rewritten to it
+        ParsedModule parsed;
+        std::vector<Str> kept;      // functions reachable from @main, sorted
+    };
+
+    /// @brief Functions reachable from @main through function constants
+    std::vector<Str> reachableFunctions(const ParsedModule& module) {
+        std::vector<Str> kept;
+        std::unordered_set<Str> seen{ "@main" };
+        std::vector<Str> pending{ "@main" };
+        while (!pending.empty()) {
+            Str name = std::move(pending.back());
+            pending.pop_back();
+            kept.push_back(name);
+            for (const Value& constant : module.functions.at(name).constantPool) {
+                if (!constant.is_string()) continue;
+                const Str& s = constant.get<Str>();
+                if (s.rfind(PROTO_PREFIX, 0) != 0) continue;
+                Str target = s.substr(PROTO_PREFIX.size());
+                if (module.functions.count(target) && seen.insert(target).second) pending.push_back(std::move(target));
+            }
+        }
+        std::sort(kept.begin(), kept.end());
+        return kept;
+    }
+
+    Str moduleKey(const std::filesystem::path& path, const std::filesystem::path& root) {
+        std::filesystem::path relative = path.lexically_relative(root);
+        if (relative.empty() || *relative.begin() == "..") return path.generic_string();
+        return relative.generic_string();
+    }
+
+    /// @brief Index of string constant `s` in `pool`, appending it if absent
+    Int internConstant(std::vector<Value>& pool, const Str& s) {
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (pool[i].is_string() && pool[i].get<Str>() == s) return static_cast<Int>(i);
+        }
+        pool.emplace_back(s);
+        return static_cast<Int>(pool.size() - 1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputPath;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (inputPath.empty()) {
+            inputPath = arg;
+        } else {
+            inputPath.clear();
+            break;
+        }
+    }
+
+    if (inputPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <entry.meow> [-o <output.meowl>]" << std::endl;
+        return 1;
+    }
+    if (outputPath.empty()) {
+        outputPath = std::filesystem::path(inputPath).replace_extension(".meowl").string();
+    }
+
+    // Walk the static import graph breadth-first; the entry module is module 0
+    ModuleResolver resolver(".");
+    BytecodeParser parser;
+    std::vector<LinkInput> modules;
+    std::unordered_map<Str, size_t> byPath;
+    Str entry = resolver.resolveSource(inputPath, ".");
+    // The VM finds each module's real path from its key and the directory the image is in
+    std::filesystem::path root = std::filesystem::absolute(outputPath).lexically_normal().parent_path();
+    modules.push_back({ entry, moduleKey(entry, root), {}, {} });
+    byPath.emplace(entry, 0);
+
+    for (size_t i = 0; i < modules.size(); ++i) {
+        modules[i].parsed = parser.readFile(modules[i].path);
+        if (!modules[i].parsed.error.empty()) {
+            std::cerr << modules[i].parsed.error << std::endl;
+            return 1;
+        }
+        if (!modules[i].parsed.functions.count("@main")) {
+            std::cerr << "Lỗi: module '" << modules[i].path << "' phải có một hàm chính tên là '@main'." << std::endl;
+            return 1;
+        }
+        modules[i].kept = reachableFunctions(modules[i].parsed);
+
+        for (const Str& name : modules[i].kept) {
+            ParsedFunction& function = modules[i].parsed.functions.at(name);
+            for (Instruction& inst : function.code) {
+                if (inst.op != OpCode::IMPORT_MODULE || inst.args.size() < 2) continue;
+                Int pathIdx = inst.args[1];
+                if (pathIdx < 0 || pathIdx >= static_cast<Int>(function.constantPool.size()) || !function.constantPool[pathIdx].is_string()) continue;
+                Str spec = function.constantPool[pathIdx].get<Str>();
+                // Native libraries are still loaded at run time
+                if (!resolver.resolveLibrary(spec, modules[i].path).empty()) continue;
+
+                Str target = resolver.resolveSource(spec, modules[i].path);
+                // No such source: a native module linked into the VM (or an error the VM reports when it runs)
+                if (!std::filesystem::is_regular_file(target)) continue;
+                auto [it, inserted] = byPath.try_emplace(target, modules.size());
+                if (inserted) modules.push_back({ target, moduleKey(target, root), {}, {} });
+                // A new constant, so other uses of the spec string keep their value
+                inst.args[1] = internConstant(function.constantPool, modules[it->second].key);
+            }
+        }
+    }
+
+    // Number every exported name once for the whole program, so an export operand means the same name in
+    // whichever module the register holds at run time, then append the numbers to the export instructions
+    std::unordered_map<Str, Int> exportNumbers;
+    auto nameAt = [](const ParsedFunction& function, Int index) -> const Str* {
+        if (index < 0 || index >= static_cast<Int>(function.constantPool.size()) || !function.constantPool[index].is_string()) return nullptr;
+        return &function.constantPool[index].get<Str>();
+    };
+    for (LinkInput& module : modules) {
+        for (const Str& name : module.kept) {
+            const ParsedFunction& function = module.parsed.functions.at(name);
+            for (const Instruction& inst : function.code) {
+                if (inst.op != OpCode::EXPORT || inst.args.size() != 2) continue;
+                if (const Str* exported = nameAt(function, inst.args[0])) exportNumbers.try_emplace(*exported, static_cast<Int>(exportNumbers.size()));
+            }
+        }
+    }
+    for (LinkInput& module : modules) {
+        for (const Str& name : module.kept) {
+            ParsedFunction& function = module.parsed.functions.at(name);
+            for (Instruction& inst : function.code) {
+                size_t nameArg;
+                if (inst.op == OpCode::EXPORT && inst.args.size() == 2) nameArg = 0;
+                else if ((inst.op == OpCode::GET_EXPORT || inst.op == OpCode::GET_MODULE_EXPORT) && inst.args.size() == 3) nameArg = 2;
+                else continue;
+                // A name no bundled module exports is left to the lookup by name, e.g. for a native library
+                const Str* exported = nameAt(function, inst.args[nameArg]);
+                auto number = exported ? exportNumbers.find(*exported) : exportNumbers.end();
+                if (number != exportNumbers.end()) inst.args.push_back(number->second);
+            }
+        }
+    }
+
+    // One image for all modules: each module's kept functions in a contiguous, sorted run
+    std::vector<BinaryFunction> functions;
+    std::vector<std::unordered_map<Str, Uint32>> scopes(modules.size());
+    std::vector<LinkedModule> table(modules.size());
+    std::vector<Str> keys;
+    for (size_t m = 0; m < modules.size(); ++m) {
+        table[m].path = static_cast<Uint32>(m);
+        table[m].firstProto = static_cast<Uint32>(functions.size());
+        table[m].protoCount = static_cast<Uint32>(modules[m].kept.size());
+        for (const Str& name : modules[m].kept) {
+            if (name == "@main") table[m].mainProto = static_cast<Uint32>(functions.size());
+            scopes[m].emplace(name, static_cast<Uint32>(functions.size()));
+            functions.push_back({ &name, &modules[m].parsed.functions.at(name), &scopes[m] });
+        }
+        keys.push_back(modules[m].key);
+    }
+
+    std::vector<char> image;
+    std::string error;
+    if (!writeBinaryImage(functions, table[0].mainProto, keys, image, error)) {
+        std::cerr << "Lỗi: " << error << std::endl;
+        return 1;
+    }
+
+    LinkedHeader header{};
+    std::memcpy(header.magic, LINKED_MAGIC, sizeof(header.magic));
+    header.version = LINKED_VERSION;
+    header.modulesOffset = sizeof(LinkedHeader);
+    header.moduleCount = static_cast<Uint32>(table.size());
+    size_t imageOffset = (sizeof(LinkedHeader) + sizeof(LinkedModule) * table.size() + 7) & ~size_t(7);
+    if (imageOffset + image.size() > std::numeric_limits<Uint32>::max()) {
+        std::cerr << "Lỗi: chương trình quá lớn cho định dạng .meowl" << std::endl;
+        return 1;
+    }
+    header.imageOffset = static_cast<Uint32>(imageOffset);
+    header.imageSize = static_cast<Uint32>(image.size());
+    header.exportCount = static_cast<Uint32>(exportNumbers.size());
+    header.fileSize = static_cast<Uint32>(imageOffset + image.size());
+
+    std::vector<char> out(imageOffset, '\0');
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + sizeof(header), table.data(), sizeof(LinkedModule) * table.size());
+    out.insert(out.end(), image.begin(), image.end());
+
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::cerr << "Lỗi: không thể ghi file " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}